@@ -0,0 +1,126 @@
+#pragma once
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Общий для llab3 и llab4 формат файлов с фигурами.
+//
+// Бинарный: 4 байта сигнатуры, 4 резервных, uint64 число фигур, затем по
+// байту типа на фигуру, выравнивание до 8 и пары double (x, y) всех вершин.
+// Текстовый: по фигуре на строку — тип и координаты вершин через пробел,
+// запятую или точку с запятой; '#' начинает комментарий.
+//
+// Разборщики только читают данные и вызывают emit(type, coords, sides) на
+// каждую фигуру; как из координат строится фигура, решает лаба.
+namespace common {
+
+constexpr size_t kFigureHeaderSize = 16;
+
+inline bool has_figure_magic(const char* data, size_t size, const char (&magic)[4]) {
+    return size >= sizeof(magic) && std::memcmp(data, magic, sizeof(magic)) == 0;
+}
+
+// sides(type) — число вершин фигуры типа type, 0 для неизвестного типа.
+template <class Sides, class Emit>
+size_t parse_figures_binary(const char* data, size_t size, Sides&& sides, Emit&& emit) {
+    if (size < kFigureHeaderSize) throw std::runtime_error("Повреждён заголовок бинарного файла");
+    uint64_t count = 0;
+    std::memcpy(&count, data + 8, sizeof(count));
+    if (count > size - kFigureHeaderSize) throw std::runtime_error("Неверное число фигур в заголовке");
+
+    const unsigned char* types = reinterpret_cast<const unsigned char*>(data + kFigureHeaderSize);
+    size_t offset = (kFigureHeaderSize + count + 7) & ~size_t(7);
+    size_t total = 0;
+    for (uint64_t i = 0; i < count; ++i) {
+        size_t n = sides(types[i]);
+        if (n == 0) throw std::runtime_error("Неизвестный тип фигуры в бинарном файле");
+        total += n;
+    }
+    if (offset > size || (size - offset) / (2 * sizeof(double)) < total) {
+        throw std::runtime_error("Бинарный файл обрезан");
+    }
+
+    const char* coords = data + offset;
+    std::vector<double> raw;
+    for (uint64_t i = 0; i < count; ++i) {
+        size_t n = sides(types[i]);
+        raw.resize(2 * n);
+        std::memcpy(raw.data(), coords, 2 * n * sizeof(double));
+        coords += 2 * n * sizeof(double);
+        emit(static_cast<int>(types[i]), raw.data(), n);
+    }
+    return count;
+}
+
+// Coord — тип, в который std::from_chars читает координаты.
+template <class Coord, class Sides, class Emit>
+size_t parse_figures_text(const char* p, const char* end, Sides&& sides, Emit&& emit) {
+    auto is_separator = [](char c) { return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r'; };
+    auto skip_separators = [&]() { while (p < end && is_separator(*p)) ++p; };
+    auto skip_comment = [&]() { while (p < end && *p != '\n') ++p; };
+    auto fail = [](size_t line, const char* what) {
+        throw std::runtime_error("Строка " + std::to_string(line) + ": " + what);
+    };
+
+    size_t loaded = 0;
+    size_t line = 0;
+    std::vector<Coord> c;
+    while (p < end) {
+        ++line;
+        skip_separators();
+        if (p == end) break;
+        if (*p == '#') skip_comment();
+        if (p < end && *p == '\n') { ++p; continue; }
+        if (p == end) break;
+
+        int type = 0;
+        auto res = std::from_chars(p, end, type);
+        if (res.ec != std::errc()) fail(line, "ожидался тип фигуры");
+        p = res.ptr;
+        size_t n = sides(type);
+        if (n == 0) fail(line, "неизвестный тип фигуры");
+
+        c.resize(2 * n);
+        for (size_t k = 0; k < 2 * n; ++k) {
+            skip_separators();
+            auto r = std::from_chars(p, end, c[k]);
+            if (r.ec != std::errc()) fail(line, "ожидалась координата");
+            p = r.ptr;
+        }
+        skip_separators();
+        if (p < end && *p == '#') skip_comment();
+        if (p < end && *p != '\n') fail(line, "лишние данные после вершин");
+        if (p < end) ++p;
+
+        emit(type, c.data(), n);
+        ++loaded;
+    }
+    return loaded;
+}
+
+// Записывает фигуры в бинарном формате: types — по байту на фигуру,
+// coords — пары (x, y) всех вершин подряд.
+inline void write_figures_binary(const std::string& path, const char (&magic)[4],
+                                 const std::vector<unsigned char>& types,
+                                 const std::vector<double>& coords) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) throw std::runtime_error("Не удалось открыть файл " + path);
+    uint32_t reserved = 0;
+    uint64_t count = types.size();
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char*>(&reserved), sizeof(reserved));
+    out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+    out.write(reinterpret_cast<const char*>(types.data()), types.size());
+    size_t padding = ((kFigureHeaderSize + count + 7) & ~size_t(7)) - (kFigureHeaderSize + count);
+    const char zeros[8] = {};
+    out.write(zeros, padding);
+    out.write(reinterpret_cast<const char*>(coords.data()), coords.size() * sizeof(double));
+    if (!out) throw std::runtime_error("Ошибка записи в файл " + path);
+}
+
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <thread>
+#include <vector>
+
+// Общие для лабораторных помощники разбиения работы по потокам.
+namespace common {
+
+// Число потоков для n элементов. threads == 0: по числу ядер, но так,
+// чтобы на поток приходилось не меньше min_per_thread элементов.
+inline size_t choose_workers(size_t n, unsigned threads, size_t min_per_thread) {
+    size_t workers = threads;
+    if (workers == 0) {
+        workers = std::max(1u, std::thread::hardware_concurrency());
+        workers = std::min(workers, (n + min_per_thread - 1) / min_per_thread);
+    }
+    return std::max<size_t>(1, std::min(workers, n));
+}
+
+// Запускает work(0..workers-1), нулевой кусок — в вызывающем потоке.
+template <class Work>
+void run_workers(size_t workers, Work&& work) {
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    for (size_t w = 1; w < workers; ++w) {
+        pool.emplace_back(std::ref(work), w);
+    }
+    work(0);
+    for (auto& t : pool) {
+        t.join();
+    }
+}
+
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+#include "parallel.h"
+
+// Общие для llab3 и llab4 накопители агрегатов по фигурам.
+namespace common {
+
+// Суммирование Ноймайера: погрешность не растёт с числом слагаемых.
+struct CompensatedSum {
+    double sum = 0.0;
+    double c = 0.0;
+    void add(double v) {
+        double t = sum + v;
+        if (std::abs(sum) >= std::abs(v)) c += (sum - t) + v;
+        else c += (v - t) + sum;
+        sum = t;
+    }
+    void merge(const CompensatedSum& other) {
+        add(other.sum);
+        add(other.c);
+    }
+    double value() const { return sum + c; }
+};
+
+// Частичные агрегаты одного потока. Рамка заводится по первой реально
+// добавленной точке, поэтому фигуры без вершин не тянут её к началу координат.
+struct PartialStats {
+    size_t count = 0;
+    CompensatedSum area, cx, cy;
+    double min_area = 0.0, max_area = 0.0;
+    bool has_box = false;
+    double min_x = 0.0, min_y = 0.0, max_x = 0.0, max_y = 0.0;
+
+    void add(double a, double x, double y) {
+        if (count == 0) {
+            min_area = max_area = a;
+        } else {
+            min_area = std::min(min_area, a);
+            max_area = std::max(max_area, a);
+        }
+        area.add(a);
+        cx.add(x);
+        cy.add(y);
+        ++count;
+    }
+    void add_box(double lx, double ly, double hx, double hy) {
+        if (!has_box) {
+            min_x = lx;
+            min_y = ly;
+            max_x = hx;
+            max_y = hy;
+            has_box = true;
+            return;
+        }
+        min_x = std::min(min_x, lx);
+        min_y = std::min(min_y, ly);
+        max_x = std::max(max_x, hx);
+        max_y = std::max(max_y, hy);
+    }
+    void merge(const PartialStats& other) {
+        if (other.count == 0) return;
+        if (count == 0) {
+            *this = other;
+            return;
+        }
+        min_area = std::min(min_area, other.min_area);
+        max_area = std::max(max_area, other.max_area);
+        if (other.has_box) add_box(other.min_x, other.min_y, other.max_x, other.max_y);
+        area.merge(other.area);
+        cx.merge(other.cx);
+        cy.merge(other.cy);
+        count += other.count;
+    }
+};
+
+// Компенсированная сумма area(i) по i < n — когда нужна только площадь.
+template <class Area>
+double total_area(size_t n, Area&& area) {
+    CompensatedSum sum;
+    for (size_t i = 0; i < n; ++i) {
+        sum.add(area(i));
+    }
+    return sum.value();
+}
+
+// Параллельная свёртка: add(i, local) копит элемент i в локальные агрегаты
+// потока, которые затем сливаются по порядку. Каждый поток пишет в общий
+// вектор один раз — соседние PartialStats лежат в одной кэш-линии.
+template <class Add>
+PartialStats reduce_stats(size_t n, unsigned threads, size_t min_per_thread, Add&& add) {
+    PartialStats total;
+    if (n == 0) return total;
+    const size_t workers = choose_workers(n, threads, min_per_thread);
+    std::vector<PartialStats> partial(workers);
+    auto work = [&](size_t w) {
+        size_t begin = n * w / workers;
+        size_t end = n * (w + 1) / workers;
+        PartialStats local;
+        for (size_t i = begin; i < end; ++i) {
+            add(i, local);
+        }
+        partial[w] = local;
+    };
+    run_workers(workers, work);
+    for (const auto& p : partial) {
+        total.merge(p);
+    }
+    return total;
+}
+
+}
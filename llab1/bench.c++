@@ -0,0 +1,267 @@
+#include "func.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+enum class PerfEvent { Cycles, BranchMisses };
+
+// Аппаратный счётчик через perf_event_open; без него — пустые значения.
+class PerfCounter {
+    int fd_ = -1;
+
+public:
+    explicit PerfCounter(PerfEvent event) {
+#if defined(__linux__)
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = event == PerfEvent::Cycles ? PERF_COUNT_HW_CPU_CYCLES : PERF_COUNT_HW_BRANCH_MISSES;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // Учитываем и потоки, порождённые во время замера (строка parallel).
+        attr.inherit = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+#else
+        (void)event;
+#endif
+    }
+    ~PerfCounter() {
+#if defined(__linux__)
+        if (fd_ >= 0) close(fd_);
+#endif
+    }
+    PerfCounter(const PerfCounter&) = delete;
+    PerfCounter& operator=(const PerfCounter&) = delete;
+
+    bool available() const { return fd_ >= 0; }
+    void start() {
+#if defined(__linux__)
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+#endif
+    }
+    uint64_t stop() {
+        uint64_t value = 0;
+#if defined(__linux__)
+        if (fd_ < 0) return 0;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        if (read(fd_, &value, sizeof(value)) != sizeof(value)) value = 0;
+#endif
+        return value;
+    }
+};
+
+uint64_t ReadTsc() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+// Исходный алгоритм без ограничения в 99 цифр — точка отсчёта.
+size_t IsdigitLoop(const char* data, size_t size, char* out) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; i++) {
+        if (std::isdigit(static_cast<unsigned char>(data[i]))) out[count++] = data[i];
+    }
+    return count;
+}
+
+struct Corpus {
+    const char* name;
+    std::function<std::string(size_t, std::mt19937_64&)> make;
+};
+
+std::string AllDigits(size_t size, std::mt19937_64& rng) {
+    std::string s(size, '0');
+    for (char& c : s) c = static_cast<char>('0' + rng() % 10);
+    return s;
+}
+
+std::string NoDigits(size_t size, std::mt19937_64& rng) {
+    std::string s(size, 'a');
+    for (char& c : s) c = static_cast<char>('a' + rng() % 26);
+    return s;
+}
+
+std::string SparseDigits(size_t size, std::mt19937_64& rng) {
+    std::string s = NoDigits(size, rng);
+    for (size_t i = 0; i < size; i++) {
+        if (rng() % 100 == 0) s[i] = static_cast<char>('0' + rng() % 10);
+    }
+    return s;
+}
+
+// Случайные кодовые точки UTF-8 длиной 1–4 байта вперемешку с ASCII и цифрами.
+std::string RandomUtf8(size_t size, std::mt19937_64& rng) {
+    std::string s;
+    s.reserve(size + 4);
+    while (s.size() < size) {
+        uint32_t cp;
+        switch (rng() % 4) {
+            case 0: cp = 0x20 + rng() % 0x5F; break;
+            case 1: cp = 0x80 + rng() % 0x780; break;
+            case 2: cp = 0x800 + rng() % 0xD000; break;
+            default: cp = 0x10000 + rng() % 0x100000; break;
+        }
+        if (cp < 0x80) {
+            s += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            s += static_cast<char>(0xC0 | (cp >> 6));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            s += static_cast<char>(0xE0 | (cp >> 12));
+            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            s += static_cast<char>(0xF0 | (cp >> 18));
+            s += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            s += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            s += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+    s.resize(size);
+    return s;
+}
+
+std::string LogLines(size_t size, std::mt19937_64& rng) {
+    static const char* levels[] = {"INFO", "WARN", "DEBUG", "ERROR"};
+    static const char* messages[] = {"request served", "cache miss for key", "retrying upstream",
+                                     "connection closed by peer", "slow query"};
+    std::string s;
+    s.reserve(size + 256);
+    char line[256];
+    while (s.size() < size) {
+        int n = std::snprintf(line, sizeof(line),
+                              "2024-%02u-%02uT%02u:%02u:%02u.%03uZ %s [worker-%u] %s id=%llu latency=%uus\n",
+                              static_cast<unsigned>(1 + rng() % 12), static_cast<unsigned>(1 + rng() % 28),
+                              static_cast<unsigned>(rng() % 24), static_cast<unsigned>(rng() % 60),
+                              static_cast<unsigned>(rng() % 60), static_cast<unsigned>(rng() % 1000),
+                              levels[rng() % 4], static_cast<unsigned>(rng() % 64), messages[rng() % 5],
+                              static_cast<unsigned long long>(rng() % 10000000000ull),
+                              static_cast<unsigned>(rng() % 100000));
+        s.append(line, static_cast<size_t>(n));
+    }
+    s.resize(size);
+    return s;
+}
+
+struct Kernel {
+    const char* name;
+    std::function<size_t(const std::string&, std::string&)> run;
+};
+
+std::vector<Kernel> MakeKernels() {
+    std::vector<Kernel> kernels = {
+        {"isdigit_loop", [](const std::string& in, std::string& out) {
+            return IsdigitLoop(in.data(), in.size(), out.data());
+        }},
+    };
+    const struct { const char* name; DigitKernel kernel; } simd[] = {
+        {"scalar", DigitKernel::Scalar}, {"sse4.2", DigitKernel::Sse42}, {"avx2", DigitKernel::Avx2}};
+    for (const auto& k : simd) {
+        if (!DigitKernelSupported(k.kernel)) continue;
+        DigitKernel kernel = k.kernel;
+        kernels.push_back({k.name, [kernel](const std::string& in, std::string& out) {
+            return ExtractDigitsWith(kernel, in.data(), in.size(), out.data());
+        }});
+    }
+    kernels.push_back({"parallel", [](const std::string& in, std::string&) {
+        // Свой выходной буфер: его размер между итерациями не меняется,
+        // и в замер не попадают перевыделение и обнуление.
+        static std::string result;
+        NumbersParallel(in, result);
+        return result.size();
+    }});
+    kernels.push_back({"tokenize", [](const std::string& in, std::string&) {
+        static std::vector<NumberToken> tokens;
+        tokens.clear();
+        return TokenizeNumbers(in, tokens);
+    }});
+    return kernels;
+}
+
+void RunCase(const char* corpus, const std::string& input, const Kernel& kernel,
+             PerfCounter& cycles, PerfCounter& branch_misses) {
+    std::string out(input.size(), '\0');
+    const size_t target_bytes = size_t{256} << 20;
+    const size_t iterations = std::max<size_t>(1, std::min<size_t>(100000, target_bytes / input.size()));
+
+    volatile size_t sink = kernel.run(input, out);
+    cycles.start();
+    branch_misses.start();
+    uint64_t tsc0 = ReadTsc();
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < iterations; i++) sink = sink + kernel.run(input, out);
+    auto t1 = Clock::now();
+    uint64_t tsc1 = ReadTsc();
+    uint64_t misses = branch_misses.stop();
+    uint64_t cycle_count = cycles.stop();
+    (void)sink;
+
+    double bytes = static_cast<double>(input.size()) * iterations;
+    double seconds = std::chrono::duration<double>(t1 - t0).count();
+    double per_byte = (cycles.available() ? cycle_count : tsc1 - tsc0) / bytes;
+    char misses_text[32] = "n/a";
+    if (branch_misses.available()) {
+        std::snprintf(misses_text, sizeof(misses_text), "%.4f", misses / bytes * 1000.0);
+    }
+    std::printf("%-14s %10zu %-16s %8.3f %10.3f %14s\n", corpus, input.size(), kernel.name,
+                bytes / seconds / 1e9, per_byte, misses_text);
+    std::fflush(stdout);
+}
+
+}
+
+// llab1_bench [максимальный размер в байтах]; по умолчанию до 64 MiB, до 1 GiB по запросу.
+int main(int argc, char** argv) {
+    size_t max_size = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : size_t{64} << 20;
+    max_size = std::clamp<size_t>(max_size, 1024, size_t{1} << 30);
+
+    const std::vector<Corpus> corpora = {
+        {"all_digits", AllDigits}, {"no_digits", NoDigits}, {"sparse_digits", SparseDigits},
+        {"random_utf8", RandomUtf8}, {"log_lines", LogLines},
+    };
+    const std::vector<Kernel> kernels = MakeKernels();
+    PerfCounter cycles(PerfEvent::Cycles);
+    PerfCounter branch_misses(PerfEvent::BranchMisses);
+
+    std::printf("active kernel: %d, cycles: %s, branch misses: %s\n", static_cast<int>(ActiveDigitKernel()),
+                cycles.available() ? "perf" : "tsc", branch_misses.available() ? "perf" : "n/a");
+    std::printf("%-14s %10s %-16s %8s %10s %14s\n", "corpus", "bytes", "kernel", "GB/s",
+                cycles.available() ? "cycles/B" : "tsc/B", "br-miss/KB");
+
+    std::mt19937_64 rng(2024);
+    for (const auto& corpus : corpora) {
+        for (size_t size = 1024; size <= max_size; size *= 32) {
+            std::string input = corpus.make(size, rng);
+            for (const auto& kernel : kernels) {
+                RunCase(corpus.name, input, kernel, cycles, branch_misses);
+            }
+        }
+    }
+    return 0;
+}
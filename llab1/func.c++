@@ -1,19 +1,512 @@
 #include "func.h"
-#include <cctype>
+#include "common/parallel.h"
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <exception>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <vector>
+#if defined(__unix__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
-const char* Numbers(const char* input) {
-    static char result[100];
-    int count = 0;
-    result[0] = '\0';
-    
-    for (int i = 0; input[i] != '\0' && count < 99; i++) {
-        if (std::isdigit(input[i])) {
-            result[count] = input[i];
-            count++;
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define NUMBERS_HAVE_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+size_t ExtractDigitsScalar(const char* data, size_t size, char* out) {
+    size_t count = 0;
+    for (size_t i = 0; i < size; i++) {
+        char c = data[i];
+        out[count] = c;
+        count += static_cast<unsigned char>(c - '0') < 10;
+    }
+    return count;
+}
+
+#ifdef NUMBERS_HAVE_X86_KERNELS
+
+// Для каждой 8-битной маски — индексы pshufb, сдвигающие отмеченные байты в начало.
+constexpr std::array<uint64_t, 256> kCompactTable = [] {
+    std::array<uint64_t, 256> table{};
+    for (unsigned mask = 0; mask < 256; mask++) {
+        uint64_t entry = 0;
+        unsigned pos = 0;
+        for (unsigned bit = 0; bit < 8; bit++) {
+            if (mask & (1u << bit)) {
+                entry |= static_cast<uint64_t>(bit) << (8 * pos++);
+            }
+        }
+        for (; pos < 8; pos++) {
+            entry |= uint64_t{0x80} << (8 * pos);
         }
+        table[mask] = entry;
     }
-    
+    return table;
+}();
+
+// Сжимает 16 байт по маске. Пишет по 8 байт на половину, поэтому в out
+// должно оставаться не меньше 16 байт — это верно, пока out не обгоняет вход.
+__attribute__((target("sse4.2,popcnt")))
+inline char* Compact16(__m128i bytes, unsigned mask, char* out) {
+    unsigned lo = mask & 0xFF;
+    unsigned hi = mask >> 8;
+    __m128i shuffle = _mm_set_epi64x(
+        static_cast<long long>(kCompactTable[hi] + 0x0808080808080808ull),
+        static_cast<long long>(kCompactTable[lo]));
+    __m128i packed = _mm_shuffle_epi8(bytes, shuffle);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+    out += __builtin_popcount(lo);
+    _mm_storel_epi64(reinterpret_cast<__m128i*>(out), _mm_srli_si128(packed, 8));
+    return out + __builtin_popcount(hi);
+}
+
+__attribute__((target("sse4.2,popcnt")))
+size_t ExtractDigitsSse42(const char* data, size_t size, char* out) {
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nine = _mm_set1_epi8(9);
+    char* dst = out;
+    size_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+        __m128i shifted = _mm_sub_epi8(bytes, zero);
+        __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(shifted, nine), shifted);
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(digits));
+        if (mask == 0) continue;
+        if (mask == 0xFFFF) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst), bytes);
+            dst += 16;
+            continue;
+        }
+        dst = Compact16(bytes, mask, dst);
+    }
+    dst += ExtractDigitsScalar(data + i, size - i, dst);
+    return static_cast<size_t>(dst - out);
+}
+
+__attribute__((target("avx2,popcnt")))
+size_t ExtractDigitsAvx2(const char* data, size_t size, char* out) {
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nine = _mm256_set1_epi8(9);
+    char* dst = out;
+    size_t i = 0;
+    for (; i + 32 <= size; i += 32) {
+        __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+        __m256i shifted = _mm256_sub_epi8(bytes, zero);
+        __m256i digits = _mm256_cmpeq_epi8(_mm256_min_epu8(shifted, nine), shifted);
+        uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(digits));
+        if (mask == 0) continue;
+        if (mask == 0xFFFFFFFFu) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), bytes);
+            dst += 32;
+            continue;
+        }
+        dst = Compact16(_mm256_castsi256_si128(bytes), mask & 0xFFFF, dst);
+        dst = Compact16(_mm256_extracti128_si256(bytes, 1), mask >> 16, dst);
+    }
+    dst += ExtractDigitsSse42(data + i, size - i, dst);
+    return static_cast<size_t>(dst - out);
+}
+
+#endif
+
+#if defined(__unix__)
+
+struct FreeDeleter {
+    void operator()(char* p) const { std::free(p); }
+};
+using AlignedBuffer = std::unique_ptr<char, FreeDeleter>;
+
+const size_t kPageSize = 4096;
+
+AlignedBuffer AllocateAligned(size_t size) {
+    char* p = static_cast<char*>(std::aligned_alloc(kPageSize, size));
+    if (!p) throw std::bad_alloc();
+    return AlignedBuffer(p);
+}
+
+void WriteAll(int fd, const char* p, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, p, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::system_error(errno, std::generic_category(), "write");
+        }
+        p += n;
+        size -= static_cast<size_t>(n);
+    }
+}
+
+// Буфер вывода: ядро пишет прямо в его хвост, сброс — одним write на весь буфер.
+class FdWriter {
+    int fd_;
+    AlignedBuffer buffer_;
+    size_t capacity_;
+    size_t size_ = 0;
+
+public:
+    FdWriter(int fd, size_t capacity) : fd_(fd), buffer_(AllocateAligned(capacity)), capacity_(capacity) {}
+
+    char* Reserve(size_t bytes) {
+        if (capacity_ - size_ < bytes) Flush();
+        return buffer_.get() + size_;
+    }
+    void Commit(size_t bytes) { size_ += bytes; }
+
+    void Flush() {
+        WriteAll(fd_, buffer_.get(), size_);
+        size_ = 0;
+    }
+};
+
+#endif
+
+const size_t kMinBytesPerThread = size_t{1} << 16;
+const size_t kWindowBytesPerThread = size_t{1} << 23;
+
+// Размечает буферы кусков под входные диапазоны до запуска потоков:
+// исключение внутри рабочего потока вызвало бы std::terminate.
+void SizeParts(size_t size, std::vector<std::string>& parts) {
+    const size_t workers = parts.size();
+    for (size_t w = 0; w < workers; ++w) {
+        parts[w].resize(size * (w + 1) / workers - size * w / workers);
+    }
+}
+
+// Каждый кусок входа — в свой буфер; ёмкость буферов сохраняется между вызовами.
+void ExtractParts(std::string_view input, std::vector<std::string>& parts) {
+    const size_t workers = parts.size();
+    SizeParts(input.size(), parts);
+    common::run_workers(workers, [&](size_t w) {
+        size_t begin = input.size() * w / workers;
+        size_t end = input.size() * (w + 1) / workers;
+        std::string& part = parts[w];
+        part.resize(ExtractDigits(input.data() + begin, end - begin, part.data()));
+    });
+}
+
+// Маска цифр для блока до 64 байт: бит i — data[i] является цифрой.
+uint64_t DigitMask(const char* data, size_t size) {
+    uint64_t mask = 0;
+#if defined(NUMBERS_HAVE_X86_KERNELS) && defined(__SSE2__)
+    if (size == 64) {
+        const __m128i zero = _mm_set1_epi8('0');
+        const __m128i nine = _mm_set1_epi8(9);
+        for (size_t i = 0; i < 64; i += 16) {
+            __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            __m128i shifted = _mm_sub_epi8(bytes, zero);
+            __m128i digits = _mm_cmpeq_epi8(_mm_min_epu8(shifted, nine), shifted);
+            mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(digits))) << i;
+        }
+        return mask;
+    }
+#endif
+    for (size_t i = 0; i < size; i++) {
+        mask |= static_cast<uint64_t>(static_cast<unsigned char>(data[i] - '0') < 10) << i;
+    }
+    return mask;
+}
+
+// Модуль числа из цифр; до 19 цифр переполнение невозможно.
+uint64_t ParseMagnitude(const char* digits, size_t length, bool& overflowed) {
+    uint64_t value = 0;
+    if (length <= 19) {
+        for (size_t i = 0; i < length; i++) value = value * 10 + static_cast<uint64_t>(digits[i] - '0');
+        overflowed = false;
+        return value;
+    }
+    overflowed = false;
+    for (size_t i = 0; i < length; i++) {
+        uint64_t next;
+        if (__builtin_mul_overflow(value, uint64_t{10}, &next) ||
+            __builtin_add_overflow(next, static_cast<uint64_t>(digits[i] - '0'), &next)) {
+            overflowed = true;
+            next = value * 10 + static_cast<uint64_t>(digits[i] - '0');
+        }
+        value = next;
+    }
+    return value;
+}
+
+void EmitToken(std::string_view input, size_t start, size_t end, const TokenizeOptions& options,
+               std::vector<NumberToken>& out) {
+    bool negative = false;
+    size_t position = start;
+    if (options.allow_sign && start > 0 && (input[start - 1] == '-' || input[start - 1] == '+')) {
+        negative = input[start - 1] == '-';
+        position = start - 1;
+    }
+
+    bool overflowed = false;
+    uint64_t magnitude = ParseMagnitude(input.data() + start, end - start, overflowed);
+    const uint64_t limit = negative ? uint64_t{1} << 63 : static_cast<uint64_t>(std::numeric_limits<int64_t>::max());
+    overflowed = overflowed || magnitude > limit;
+
+    NumberToken token;
+    token.position = position;
+    token.length = end - position;
+    token.overflowed = overflowed;
+    if (overflowed && options.overflow == OverflowPolicy::Error) {
+        throw std::out_of_range("number at offset " + std::to_string(position) + " does not fit in int64");
+    }
+    if (overflowed && options.overflow == OverflowPolicy::Saturate) {
+        token.value = negative ? std::numeric_limits<int64_t>::min() : std::numeric_limits<int64_t>::max();
+    } else {
+        token.value = static_cast<int64_t>(negative ? uint64_t{0} - magnitude : magnitude);
+    }
+    out.push_back(token);
+}
+
+using KernelFn = size_t (*)(const char*, size_t, char*);
+
+KernelFn KernelFor(DigitKernel kernel) {
+    switch (kernel) {
+#ifdef NUMBERS_HAVE_X86_KERNELS
+        case DigitKernel::Avx2: return ExtractDigitsAvx2;
+        case DigitKernel::Sse42: return ExtractDigitsSse42;
+#endif
+        default: return ExtractDigitsScalar;
+    }
+}
+
+}
+
+bool DigitKernelSupported(DigitKernel kernel) {
+    switch (kernel) {
+        case DigitKernel::Scalar:
+            return true;
+#ifdef NUMBERS_HAVE_X86_KERNELS
+        case DigitKernel::Sse42:
+            return __builtin_cpu_supports("sse4.2") && __builtin_cpu_supports("popcnt");
+        case DigitKernel::Avx2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+        default:
+            return false;
+    }
+}
+
+DigitKernel ActiveDigitKernel() {
+    static const DigitKernel active = [] {
+        for (DigitKernel kernel : {DigitKernel::Avx2, DigitKernel::Sse42}) {
+            if (DigitKernelSupported(kernel)) return kernel;
+        }
+        return DigitKernel::Scalar;
+    }();
+    return active;
+}
+
+size_t ExtractDigits(const char* data, size_t size, char* out) {
+    static const KernelFn kernel = KernelFor(ActiveDigitKernel());
+    return kernel(data, size, out);
+}
+
+size_t ExtractDigitsWith(DigitKernel kernel, const char* data, size_t size, char* out) {
+    if (!DigitKernelSupported(kernel)) kernel = DigitKernel::Scalar;
+    return KernelFor(kernel)(data, size, out);
+}
+
+size_t Numbers(std::string_view input, std::span<char> output) {
+    if (output.size() >= input.size()) {
+        return ExtractDigits(input.data(), input.size(), output.data());
+    }
+    size_t total = 0;
+    char block[256];
+    for (size_t pos = 0; pos < input.size(); pos += sizeof(block)) {
+        size_t len = std::min(sizeof(block), input.size() - pos);
+        size_t found = ExtractDigits(input.data() + pos, len, block);
+        if (total < output.size()) {
+            std::memcpy(output.data() + total, block, std::min(found, output.size() - total));
+        }
+        total += found;
+    }
+    return total;
+}
+
+void Numbers(std::string_view input, std::string& output) {
+    output.resize(input.size());
+    output.resize(ExtractDigits(input.data(), input.size(), output.data()));
+}
+
+#if defined(__unix__)
+
+StreamStats ExtractDigitsStream(int in_fd, int out_fd, size_t chunk_size) {
+    chunk_size = std::max(kPageSize, (chunk_size + kPageSize - 1) / kPageSize * kPageSize);
+    auto start = std::chrono::steady_clock::now();
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(in_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    AlignedBuffer input = AllocateAligned(chunk_size);
+    FdWriter writer(out_fd, chunk_size * 4);
+    StreamStats stats;
+
+    for (;;) {
+        ssize_t n = ::read(in_fd, input.get(), chunk_size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (n == 0) break;
+        size_t len = static_cast<size_t>(n);
+        size_t found = ExtractDigits(input.get(), len, writer.Reserve(len));
+        writer.Commit(found);
+        stats.bytes_in += len;
+        stats.bytes_out += found;
+    }
+    writer.Flush();
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+#endif
+
+void NumbersParallel(std::string_view input, std::string& output, unsigned threads) {
+    const size_t workers = common::choose_workers(input.size(), threads, kMinBytesPerThread);
+    if (workers == 1) {
+        Numbers(input, output);
+        return;
+    }
+
+    // Один запуск потоков: кусок выделяется в свой буфер, на барьере один поток
+    // считает префиксные суммы и размер результата, затем все копируют на место.
+    // После старта потоков ничего не должно бросать: иначе остальные ждали бы на барьере.
+    std::vector<std::string> parts(workers);
+    SizeParts(input.size(), parts);
+    std::vector<size_t> offsets(workers + 1, 0);
+    std::exception_ptr failure;
+    auto splice = [&]() noexcept {
+        for (size_t w = 0; w < workers; ++w) {
+            offsets[w + 1] = offsets[w] + parts[w].size();
+        }
+        try {
+            output.resize(offsets[workers]);
+        } catch (...) {
+            failure = std::current_exception();
+        }
+    };
+    std::barrier sync(static_cast<std::ptrdiff_t>(workers), splice);
+    common::run_workers(workers, [&](size_t w) {
+        size_t begin = input.size() * w / workers;
+        size_t end = input.size() * (w + 1) / workers;
+        std::string& part = parts[w];
+        part.resize(ExtractDigits(input.data() + begin, end - begin, part.data()));
+        sync.arrive_and_wait();
+        if (!failure) {
+            std::memcpy(output.data() + offsets[w], part.data(), part.size());
+        }
+    });
+    if (failure) std::rethrow_exception(failure);
+}
+
+#if defined(__unix__)
+
+StreamStats ExtractDigitsFileParallel(int in_fd, int out_fd, unsigned threads) {
+    auto start = std::chrono::steady_clock::now();
+    struct stat st {};
+    if (::fstat(in_fd, &st) != 0) {
+        throw std::system_error(errno, std::generic_category(), "fstat");
+    }
+    if (!S_ISREG(st.st_mode)) {
+        throw std::system_error(std::make_error_code(std::errc::invalid_argument), "input is not a regular file");
+    }
+
+    StreamStats stats;
+    const size_t size = static_cast<size_t>(st.st_size);
+    if (size == 0) return stats;
+
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, in_fd, 0);
+    if (mapped == MAP_FAILED) {
+        throw std::system_error(errno, std::generic_category(), "mmap");
+    }
+    struct Unmapper {
+        void* p;
+        size_t size;
+        ~Unmapper() { ::munmap(p, size); }
+    } guard{mapped, size};
+    ::madvise(mapped, size, MADV_SEQUENTIAL);
+
+    std::string_view input(static_cast<const char*>(mapped), size);
+    const size_t workers = common::choose_workers(size, threads, kMinBytesPerThread);
+    const size_t window = workers * kWindowBytesPerThread;
+    std::vector<std::string> parts(workers);
+
+    for (size_t pos = 0; pos < size; pos += window) {
+        ExtractParts(input.substr(pos, window), parts);
+        for (const auto& part : parts) {
+            WriteAll(out_fd, part.data(), part.size());
+            stats.bytes_out += part.size();
+        }
+    }
+    stats.bytes_in = size;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+#endif
+
+size_t TokenizeNumbers(std::string_view input, std::vector<NumberToken>& out, const TokenizeOptions& options) {
+    const size_t before = out.size();
+    bool in_run = false;
+    size_t run_start = 0;
+
+    // Границы чисел — переходы в маске цифр; число может продолжаться в следующем блоке.
+    for (size_t base = 0; base < input.size(); base += 64) {
+        size_t len = std::min<size_t>(64, input.size() - base);
+        uint64_t bits = DigitMask(input.data() + base, len);
+        size_t bit = 0;
+        while (bit < len) {
+            if (in_run) {
+                uint64_t zeros = ~bits >> bit;
+                if (zeros == 0) break;
+                bit += static_cast<size_t>(__builtin_ctzll(zeros));
+                if (bit >= len) break;
+                EmitToken(input, run_start, base + bit, options, out);
+                in_run = false;
+            } else {
+                uint64_t ones = bits >> bit;
+                if (ones == 0) break;
+                bit += static_cast<size_t>(__builtin_ctzll(ones));
+                run_start = base + bit;
+                in_run = true;
+            }
+        }
+    }
+    if (in_run) {
+        EmitToken(input, run_start, input.size(), options, out);
+    }
+    return out.size() - before;
+}
+
+const char* Numbers(const char* input) {
+    thread_local char result[100];
+    size_t count = 0;
+    char block[64];
+
+    while (count < 99) {
+        size_t len = strnlen(input, sizeof(block));
+        size_t found = ExtractDigits(input, len, block);
+        size_t take = std::min(found, 99 - count);
+        std::memcpy(result + count, block, take);
+        count += take;
+        input += len;
+        if (len < sizeof(block)) break;
+    }
+
     result[count] = '\0';
     return result;
-}
\ No newline at end of file
+}
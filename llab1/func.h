@@ -1,3 +1,71 @@
 #pragma once 
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
 
-const char* Numbers(const char* input);
\ No newline at end of file
+// Буфер результата свой у каждого потока; не больше 99 цифр.
+const char* Numbers(const char* input);
+// Реентерабельные варианты без ограничения длины. Версия со span пишет не больше
+// output.size() цифр и возвращает их общее число во входе (как snprintf).
+size_t Numbers(std::string_view input, std::span<char> output);
+// Заменяет содержимое output; память строки переиспользуется между вызовами.
+void Numbers(std::string_view input, std::string& output);
+
+// Ядра выделения цифр: копируют все цифры из data[0..size) в out и возвращают их число.
+// В out должно быть место под size байт.
+enum class DigitKernel { Scalar, Sse42, Avx2 };
+
+bool DigitKernelSupported(DigitKernel kernel);
+// Лучшее ядро для текущего процессора; выбирается один раз при первом вызове.
+DigitKernel ActiveDigitKernel();
+size_t ExtractDigits(const char* data, size_t size, char* out);
+size_t ExtractDigitsWith(DigitKernel kernel, const char* data, size_t size, char* out);
+
+// Потоковое выделение цифр из дескриптора in_fd в out_fd: вход читается
+// выровненными блоками по chunk_size байт, выход копится в буфере и пишется
+// крупными порциями. Память не зависит от размера входа.
+// При ошибке ввода-вывода бросает std::system_error.
+struct StreamStats {
+    uint64_t bytes_in = 0;
+    uint64_t bytes_out = 0;
+    double seconds = 0.0;
+};
+
+#if defined(__unix__)
+StreamStats ExtractDigitsStream(int in_fd, int out_fd, size_t chunk_size = size_t{1} << 20);
+#endif
+
+// Параллельное выделение: вход делится на куски по потокам, каждый кусок
+// обрабатывается в свой буфер, затем буферы склеиваются по префиксным суммам
+// длин. Результат побайтно совпадает с последовательной версией.
+// threads == 0: число потоков выбирается по размеру входа и числу ядер.
+void NumbersParallel(std::string_view input, std::string& output, unsigned threads = 0);
+// То же для файла: вход отображается в память и обрабатывается окнами,
+// выход пишется в out_fd по порядку. in_fd должен быть обычным файлом.
+#if defined(__unix__)
+StreamStats ExtractDigitsFileParallel(int in_fd, int out_fd, unsigned threads = 0);
+#endif
+
+// Разбор чисел с сохранением границ: "a12b345" -> 12, 345.
+// Saturate — прижать к границе int64, Wrap — по модулю 2^64,
+// Error — бросить std::out_of_range.
+enum class OverflowPolicy { Saturate, Wrap, Error };
+
+struct TokenizeOptions {
+    // '+' или '-' непосредственно перед цифрами входит в число.
+    bool allow_sign = false;
+    OverflowPolicy overflow = OverflowPolicy::Saturate;
+};
+
+struct NumberToken {
+    int64_t value = 0;
+    size_t position = 0;  // смещение первого символа числа (вместе со знаком)
+    size_t length = 0;
+    bool overflowed = false;
+};
+
+// Дописывает числа из input в out за один проход; возвращает число добавленных.
+size_t TokenizeNumbers(std::string_view input, std::vector<NumberToken>& out, const TokenizeOptions& options = {});
@@ -1,13 +1,74 @@
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <cstdlib>
+#include <exception>
 #include "func.h"
+#if defined(__unix__)
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
-int main()
+namespace {
+
+#if defined(__unix__)
+
+// llab1_exe --stream [вход] [выход]: "-" или отсутствие аргумента — stdin/stdout.
+// llab1_exe --parallel вход [выход] [потоки]: вход — обычный файл, читается через mmap.
+int RunStream(int argc, char** argv, bool parallel)
 {
-  char input[100];
+  std::string_view in_path = argc > 2 ? argv[2] : "-";
+  std::string_view out_path = argc > 3 ? argv[3] : "-";
+
+  int in_fd = in_path == "-" ? STDIN_FILENO : ::open(argv[2], O_RDONLY);
+  if (in_fd < 0) {
+    std::cerr << "не удалось открыть " << in_path << std::endl;
+    return 1;
+  }
+  int out_fd = out_path == "-" ? STDOUT_FILENO : ::open(argv[3], O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (out_fd < 0) {
+    std::cerr << "не удалось открыть " << out_path << std::endl;
+    if (in_fd != STDIN_FILENO) ::close(in_fd);
+    return 1;
+  }
+
+  int rc = 0;
+  try {
+    unsigned threads = argc > 4 ? static_cast<unsigned>(std::strtoul(argv[4], nullptr, 10)) : 0;
+    StreamStats stats = parallel ? ExtractDigitsFileParallel(in_fd, out_fd, threads)
+                                 : ExtractDigitsStream(in_fd, out_fd);
+    double mb = stats.bytes_in / 1e6;
+    std::cerr << "обработано " << mb << " MB, найдено " << stats.bytes_out << " цифр, "
+              << (stats.seconds > 0 ? mb / stats.seconds : 0.0) << " MB/s" << std::endl;
+  } catch (const std::exception& e) {
+    std::cerr << "ошибка: " << e.what() << std::endl;
+    rc = 1;
+  }
+
+  if (in_fd != STDIN_FILENO) ::close(in_fd);
+  if (out_fd != STDOUT_FILENO) ::close(out_fd);
+  return rc;
+}
+#endif
+
+}
+
+int main(int argc, char** argv)
+{
+  std::string_view mode = argc > 1 ? argv[1] : "";
+#if defined(__unix__)
+  if (mode == "--stream" || mode == "--parallel") {
+    return RunStream(argc, argv, mode == "--parallel");
+  }
+#endif
+
+  std::string input;
   std::cout << "Введите строку:";
-  std::cin.getline(input, 100);
+  std::getline(std::cin, input);
 
-  std::cout << "результат: " << Numbers(input) << std::endl;
+  std::string result;
+  Numbers(input, result);
+  std::cout << "результат: " << result << std::endl;
 
   return 0;
-}
\ No newline at end of file
+}
@@ -1,5 +1,13 @@
 #include <gtest/gtest.h>
 #include "func.h"
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#if defined(__unix__)
+#include <unistd.h>
+#endif
 
 TEST(test_01, basic_test_set)
 {
@@ -26,6 +34,241 @@ TEST(test_05, basic_test_set)
     ASSERT_STREQ(Numbers("456654"), "456654");
 }
 
+TEST(test_06, basic_test_set)
+{
+    std::string input(250, 'x');
+    for (size_t i = 0; i < input.size(); i += 2) input[i] = '7';
+    ASSERT_EQ(std::string(Numbers(input.c_str())), std::string(99, '7'));
+}
+
+TEST(test_07, kernel_test_set)
+{
+    std::mt19937 rng(42);
+    const char alphabet[] = "0123456789abc/:; \xff";
+    for (size_t len : {0, 1, 15, 16, 17, 31, 32, 33, 64, 100, 1000, 4099}) {
+        std::string input(len, ' ');
+        for (char& c : input) c = alphabet[rng() % (sizeof(alphabet) - 1)];
+        if (len > 0) input[len / 2] = static_cast<char>(0xB9);
+
+        std::string expected;
+        for (char c : input) {
+            if (c >= '0' && c <= '9') expected += c;
+        }
+        for (DigitKernel kernel : {DigitKernel::Scalar, DigitKernel::Sse42, DigitKernel::Avx2}) {
+            std::string out(len, '\0');
+            size_t count = ExtractDigitsWith(kernel, input.data(), input.size(), out.data());
+            out.resize(count);
+            ASSERT_EQ(out, expected) << "kernel " << static_cast<int>(kernel) << ", length " << len;
+        }
+    }
+}
+
+TEST(test_08, kernel_test_set)
+{
+    std::string digits(96, '5');
+    std::string out(digits.size(), '\0');
+    ASSERT_EQ(ExtractDigits(digits.data(), digits.size(), out.data()), 96u);
+    ASSERT_EQ(out, digits);
+    ASSERT_TRUE(DigitKernelSupported(DigitKernel::Scalar));
+    ASSERT_TRUE(DigitKernelSupported(ActiveDigitKernel()));
+}
+
+TEST(test_09, reentrant_test_set)
+{
+    std::string input(1000, 'a');
+    for (size_t i = 0; i < input.size(); i += 3) input[i] = static_cast<char>('0' + i % 10);
+    std::string expected;
+    for (char c : input) {
+        if (c >= '0' && c <= '9') expected += c;
+    }
+
+    std::string out = "stale";
+    Numbers(input, out);
+    ASSERT_EQ(out, expected);
+
+    std::string_view unterminated("12ab34", 3);
+    Numbers(unterminated, out);
+    ASSERT_EQ(out, "12");
+
+    char small[10];
+    ASSERT_EQ(Numbers(input, std::span<char>(small)), expected.size());
+    ASSERT_EQ(std::string(small, sizeof(small)), expected.substr(0, sizeof(small)));
+
+    std::vector<char> exact(expected.size());
+    ASSERT_EQ(Numbers(input, std::span<char>(exact)), expected.size());
+    ASSERT_EQ(std::string(exact.begin(), exact.end()), expected);
+}
+
+TEST(test_10, reentrant_test_set)
+{
+    std::vector<std::string> results(4);
+    std::vector<std::thread> workers;
+    for (size_t t = 0; t < results.size(); t++) {
+        workers.emplace_back([&results, t] {
+            std::string input = "x" + std::to_string(t) + "y";
+            for (int i = 0; i < 1000; i++) {
+                Numbers(input, results[t]);
+                if (std::string(Numbers(input.c_str())) != results[t]) results[t] = "mismatch";
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+    for (size_t t = 0; t < results.size(); t++) {
+        ASSERT_EQ(results[t], std::to_string(t));
+    }
+}
+
+#if defined(__unix__)
+TEST(test_11, stream_test_set)
+{
+    std::string input;
+    for (int i = 0; i < 3000; i++) input += "id=" + std::to_string(i) + ";";
+    std::string expected;
+    Numbers(input, expected);
+
+    FILE* in = std::tmpfile();
+    FILE* out = std::tmpfile();
+    ASSERT_NE(in, nullptr);
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(std::fwrite(input.data(), 1, input.size(), in), input.size());
+    std::fflush(in);
+    ::lseek(fileno(in), 0, SEEK_SET);
+
+    StreamStats stats = ExtractDigitsStream(fileno(in), fileno(out), 4096);
+    ASSERT_EQ(stats.bytes_in, input.size());
+    ASSERT_EQ(stats.bytes_out, expected.size());
+
+    std::string written(expected.size(), '\0');
+    ::lseek(fileno(out), 0, SEEK_SET);
+    ASSERT_EQ(::read(fileno(out), written.data(), written.size()), static_cast<ssize_t>(written.size()));
+    ASSERT_EQ(written, expected);
+    std::fclose(in);
+    std::fclose(out);
+
+    ASSERT_THROW(ExtractDigitsStream(-1, STDOUT_FILENO), std::system_error);
+}
+#endif
+
+TEST(test_12, parallel_test_set)
+{
+    std::mt19937 rng(7);
+    std::string input(300000, ' ');
+    for (char& c : input) c = static_cast<char>(rng() % 3 == 0 ? '0' + rng() % 10 : 'a' + rng() % 26);
+    std::string expected;
+    Numbers(input, expected);
+
+    for (unsigned threads : {0u, 1u, 3u, 8u}) {
+        std::string out;
+        NumbersParallel(input, out, threads);
+        ASSERT_EQ(out, expected) << threads << " threads";
+    }
+    std::string out = "stale";
+    NumbersParallel(std::string_view(), out, 4);
+    ASSERT_EQ(out, "");
+}
+
+#if defined(__unix__)
+TEST(test_13, parallel_test_set)
+{
+    std::string input;
+    for (int i = 0; i < 50000; i++) input += "t" + std::to_string(i * 7) + " ";
+    std::string expected;
+    Numbers(input, expected);
+
+    FILE* in = std::tmpfile();
+    FILE* out = std::tmpfile();
+    ASSERT_NE(in, nullptr);
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(std::fwrite(input.data(), 1, input.size(), in), input.size());
+    std::fflush(in);
+
+    StreamStats stats = ExtractDigitsFileParallel(fileno(in), fileno(out), 4);
+    ASSERT_EQ(stats.bytes_in, input.size());
+    ASSERT_EQ(stats.bytes_out, expected.size());
+
+    std::string written(expected.size(), '\0');
+    ::lseek(fileno(out), 0, SEEK_SET);
+    ASSERT_EQ(::read(fileno(out), written.data(), written.size()), static_cast<ssize_t>(written.size()));
+    ASSERT_EQ(written, expected);
+    std::fclose(in);
+    std::fclose(out);
+
+    int fds[2];
+    ASSERT_EQ(::pipe(fds), 0);
+    ASSERT_THROW(ExtractDigitsFileParallel(fds[0], STDOUT_FILENO), std::system_error);
+    ::close(fds[0]);
+    ::close(fds[1]);
+}
+#endif
+
+TEST(test_14, tokenizer_test_set)
+{
+    std::vector<NumberToken> tokens;
+    ASSERT_EQ(TokenizeNumbers("a12b345 x-7+0", tokens), 4u);
+    ASSERT_EQ(tokens[0].value, 12);
+    ASSERT_EQ(tokens[0].position, 1u);
+    ASSERT_EQ(tokens[0].length, 2u);
+    ASSERT_EQ(tokens[1].value, 345);
+    ASSERT_EQ(tokens[2].value, 7);
+    ASSERT_EQ(tokens[3].value, 0);
+
+    tokens.clear();
+    TokenizeOptions signs;
+    signs.allow_sign = true;
+    TokenizeNumbers("a12b345 x-7+0", tokens, signs);
+    ASSERT_EQ(tokens[2].value, -7);
+    ASSERT_EQ(tokens[2].position, 9u);
+    ASSERT_EQ(tokens[2].length, 2u);
+    ASSERT_EQ(tokens[3].value, 0);
+    ASSERT_EQ(tokens[3].position, 11u);
+
+    tokens.clear();
+    ASSERT_EQ(TokenizeNumbers("", tokens), 0u);
+    ASSERT_EQ(TokenizeNumbers("no digits here", tokens), 0u);
+}
+
+TEST(test_15, tokenizer_test_set)
+{
+    std::string input;
+    std::vector<int64_t> expected;
+    for (int i = 0; i < 2000; i++) {
+        int64_t value = static_cast<int64_t>(i) * 1000003;
+        input += std::string(static_cast<size_t>(i % 70 + 1), 'z') + std::to_string(value);
+        expected.push_back(value);
+    }
+    std::vector<NumberToken> tokens;
+    ASSERT_EQ(TokenizeNumbers(input, tokens), expected.size());
+    for (size_t i = 0; i < expected.size(); i++) {
+        ASSERT_EQ(tokens[i].value, expected[i]);
+        ASSERT_EQ(input.substr(tokens[i].position, tokens[i].length), std::to_string(expected[i]));
+    }
+}
+
+TEST(test_16, tokenizer_test_set)
+{
+    TokenizeOptions options;
+    options.allow_sign = true;
+    std::vector<NumberToken> tokens;
+    TokenizeNumbers("9223372036854775807 -9223372036854775808 9223372036854775808 -99999999999999999999", tokens, options);
+    ASSERT_EQ(tokens[0].value, INT64_MAX);
+    ASSERT_FALSE(tokens[0].overflowed);
+    ASSERT_EQ(tokens[1].value, INT64_MIN);
+    ASSERT_FALSE(tokens[1].overflowed);
+    ASSERT_EQ(tokens[2].value, INT64_MAX);
+    ASSERT_TRUE(tokens[2].overflowed);
+    ASSERT_EQ(tokens[3].value, INT64_MIN);
+
+    tokens.clear();
+    options.overflow = OverflowPolicy::Wrap;
+    TokenizeNumbers("9223372036854775808 18446744073709551617", tokens, options);
+    ASSERT_EQ(tokens[0].value, INT64_MIN);
+    ASSERT_EQ(tokens[1].value, 1);
+    ASSERT_TRUE(tokens[1].overflowed);
+
+    options.overflow = OverflowPolicy::Error;
+    ASSERT_THROW(TokenizeNumbers("1 2 99999999999999999999", tokens, options), std::out_of_range);
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -4,6 +4,10 @@
 #include <vector>
 #include <memory>
 #include <iostream>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <string>
 
 void showMenu();
 
@@ -19,15 +23,23 @@ public:
     virtual void print(std::ostream& os) const = 0;
     virtual void read(std::istream& is) = 0;
     virtual Point center() const = 0;
+    // Ограничивающий прямоугольник: левый нижний и правый верхний углы.
+    virtual void bounds(Point& lo, Point& hi) const = 0;
+    // Принадлежит ли точка фигуре и пересекает ли фигура прямоугольник [lo, hi].
+    virtual bool contains(const Point& p) const = 0;
+    virtual bool intersects(const Point& lo, const Point& hi) const = 0;
 };
 
 class RegularPolygon : public Figure {
 protected:
     std::vector<Point> vertices;
     Point center_;
+    Point lo_, hi_;
+    double area_ = 0.0;
     int sides = 0;
 
-    void calculateCenter();  
+    // Пересчитывает кэшированные центр и площадь; вызывается после любого изменения вершин.
+    void updateCache();
 
 public:
     RegularPolygon() = default;
@@ -37,6 +49,10 @@ public:
     void print(std::ostream& os) const override;
     void read(std::istream& is) override;
     Point center() const override;
+    void bounds(Point& lo, Point& hi) const override;
+    bool contains(const Point& p) const override;
+    bool intersects(const Point& lo, const Point& hi) const override;
+    const std::vector<Point>& getVertices() const { return vertices; }
 };
 
 class Pentagon : public RegularPolygon {
@@ -60,19 +76,144 @@ public:
     void read(std::istream& is) override;
 };
 
+struct FigureStats {
+    size_t count = 0;
+    double totalArea = 0;
+    double minArea = 0;
+    double maxArea = 0;
+    Point lo, hi;       // общий ограничивающий прямоугольник
+    Point meanCenter;   // среднее геометрических центров
+};
+
 class FigureArray {
 private:
     std::vector<std::shared_ptr<Figure>> figures;
 
 public:
+    // Агрегаты считаются параллельно по блокам с компенсированным суммированием.
+    // threads == 0: число потоков выбирается по размеру массива и числу ядер.
+    FigureStats stats(unsigned threads = 0) const;
+
     void addFigure(std::shared_ptr<Figure> figure);
+    void reserve(size_t count);
     void removeFigure(int index);
+    // Удаление за O(1): на место удалённой фигуры переносится последняя, порядок не сохраняется.
+    void removeFigureUnordered(int index);
     void printAll() const;
     double totalArea() const;
     std::shared_ptr<Figure> operator[](size_t index) const;
     size_t size() const;
 };
 
+// Аллокатор с выравниванием по строке кэша для колонок FigureStore.
+template <typename T, size_t Align = 64>
+struct AlignedAllocator {
+    using value_type = T;
+    template <typename U> struct rebind { using other = AlignedAllocator<U, Align>; };
+
+    AlignedAllocator() = default;
+    template <typename U>
+    AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+    T* allocate(size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+    void deallocate(T* p, size_t) {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+    template <typename U>
+    bool operator==(const AlignedAllocator<U, Align>&) const { return true; }
+    template <typename U>
+    bool operator!=(const AlignedAllocator<U, Align>&) const { return false; }
+};
+
+// Колоночное хранилище многоугольников: фигуры группируются по числу вершин,
+// а i-я вершина всех фигур группы лежит в отдельных массивах xs[i] и ys[i].
+// Площади и центры всей группы считаются одним проходом по колонкам.
+class FigureStore {
+public:
+    using Column = std::vector<double, AlignedAllocator<double>>;
+
+    void addFigure(const std::vector<Point>& vertices);
+    void addFigure(const RegularPolygon& polygon);
+    void clear();
+
+    size_t size() const { return figureCount; }
+    double totalArea() const;
+    // Площади и центры в порядке добавления фигур.
+    void areas(std::vector<double>& out) const;
+    void centers(std::vector<Point>& out) const;
+
+private:
+    struct Group {
+        size_t sides = 0;
+        std::vector<Column> xs;
+        std::vector<Column> ys;
+        std::vector<size_t> ids;
+        size_t count() const { return ids.size(); }
+    };
+
+    std::vector<Group> groups;
+    size_t figureCount = 0;
+
+    size_t groupFor(size_t sides);
+    static void groupAreas(const Group& group, Column& out);
+};
+
+// Пространственный индекс над снимком FigureArray: упакованное R-дерево (STR),
+// построенное по ограничивающим прямоугольникам фигур. Запросы возвращают
+// индексы фигур в исходном массиве в порядке возрастания.
+class FigureIndex {
+public:
+    FigureIndex() = default;
+    explicit FigureIndex(const FigureArray& figures) { build(figures); }
+
+    void build(const FigureArray& figures);
+    size_t size() const { return items.size(); }
+
+    std::vector<size_t> containing(const Point& p) const;
+    std::vector<size_t> intersecting(const Point& lo, const Point& hi) const;
+    // Пакетный вариант: out[i] — фигуры, содержащие points[i].
+    void containingBatch(const std::vector<Point>& points, std::vector<std::vector<size_t>>& out) const;
+
+private:
+    static constexpr size_t kNodeCapacity = 16;
+
+    struct Box {
+        double minX, minY, maxX, maxY;
+        bool overlaps(const Box& other) const {
+            return minX <= other.maxX && other.minX <= maxX && minY <= other.maxY && other.minY <= maxY;
+        }
+    };
+    struct Node {
+        Box box;
+        size_t first;   // первый потомок (или элемент для листа)
+        size_t count;
+        bool leaf;
+    };
+    struct Item {
+        Box box;
+        size_t id;
+    };
+
+    std::vector<Item> items;
+    std::vector<Node> nodes;    // корень — последний узел
+    std::vector<std::shared_ptr<Figure>> figures;
+
+    template <typename Visit>
+    void query(const Box& window, Visit&& visit) const;
+};
+
+// Пакетная загрузка фигур из файла без интерактивных подсказок. Формат
+// определяется по сигнатуре. Текстовый: одна фигура на строку, "<тип> x1 y1 x2 y2 ...",
+// тип как в меню (1 — пятиугольник, 2 — шестиугольник, 3 — восьмиугольник),
+// разделители — пробелы или запятые, '#' начинает комментарий.
+// Бинарный: "FIG1", 4 резервных байта, число фигур (uint64), типы (uint8 на фигуру),
+// выравнивание до 8 байт и упакованные координаты double (x, y для каждой вершины).
+// При ошибке формата бросает std::runtime_error. Возвращает число загруженных фигур.
+size_t loadFigures(const std::string& path, FigureArray& out);
+void saveFiguresBinary(const std::string& path, const FigureArray& figures);
+
 std::ostream& operator<<(std::ostream& os, const Figure& figure);
 std::istream& operator>>(std::istream& is, Figure& figure);
 
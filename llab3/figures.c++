@@ -1,9 +1,57 @@
 #include "figure.h"
+#include "common/figure_format.h"
+#include "common/mapped_file.h"
+#include "common/stats.h"
 #include <iostream>
 #include <cmath>
 #include <limits>
 #include <sstream>
 #include <string>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace {
+
+const size_t kMinFiguresPerThread = 4096;
+
+const char kBinaryMagic[4] = {'F', 'I', 'G', '1'};
+
+using common::MappedFile;
+
+// Число вершин для типа фигуры из меню; 0 — неизвестный тип.
+size_t sidesForType(int type) {
+    switch (type) {
+        case 1: return 5;
+        case 2: return 6;
+        case 3: return 8;
+        default: return 0;
+    }
+}
+
+std::shared_ptr<Figure> makeFigure(int type, const double* coords, size_t sides) {
+    std::vector<Point> vertices(sides);
+    for (size_t v = 0; v < sides; ++v) {
+        vertices[v] = Point(coords[2 * v], coords[2 * v + 1]);
+    }
+    switch (type) {
+        case 1: return std::make_shared<Pentagon>(vertices);
+        case 2: return std::make_shared<Hexagon>(vertices);
+        default: return std::make_shared<Octagon>(vertices);
+    }
+}
+
+// Добавляет разобранные фигуры в out только если весь файл прочитан без ошибок.
+void appendAll(std::vector<std::shared_ptr<Figure>>& parsed, FigureArray& out) {
+    out.reserve(out.size() + parsed.size());
+    for (auto& figure : parsed) {
+        out.addFigure(std::move(figure));
+    }
+}
+
+using common::PartialStats;
+
+}
 
 void showMenu() {
     std::cout << "1. Добавить пятиугольник" << std::endl;
@@ -12,36 +60,49 @@ void showMenu() {
     std::cout << "4. Показать все фигуры" << std::endl;
     std::cout << "5. Вычислить общую площадь" << std::endl;
     std::cout << "6. Удалить фигуру по индексу" << std::endl;
+    std::cout << "7. Загрузить фигуры из файла" << std::endl;
     std::cout << "0. Выход" << std::endl;
     std::cout << "Выберите опцию: ";
 }
 
 RegularPolygon::RegularPolygon(const std::vector<Point>& vertices) 
     : vertices(vertices) {
-    calculateCenter();
+    updateCache();
 }
 
-void RegularPolygon::calculateCenter() {
+void RegularPolygon::updateCache() {
+    int n = vertices.size();
+    if (n == 0) {
+        center_ = lo_ = hi_ = Point();
+        area_ = 0.0;
+        return;
+    }
+
     double sum_x = 0, sum_y = 0;
     for (const auto& vertex : vertices) {
         sum_x += vertex.x;
         sum_y += vertex.y;
     }
-    center_.x = sum_x / vertices.size();
-    center_.y = sum_y / vertices.size();
-}
+    center_.x = sum_x / n;
+    center_.y = sum_y / n;
 
-double RegularPolygon::area() const {
     double area = 0.0;
-    int n = vertices.size();
-    
     // Формула площади Гаусса (формула шнуровки)
     for (int i = 0; i < n; i++) {
         int j = (i + 1) % n;
         area += vertices[i].x * vertices[j].y - vertices[j].x * vertices[i].y;
     }
-    
-    return std::abs(area) / 2.0;
+    area_ = std::abs(area) / 2.0;
+
+    lo_ = hi_ = vertices[0];
+    for (const auto& vertex : vertices) {
+        lo_ = Point(std::min(lo_.x, vertex.x), std::min(lo_.y, vertex.y));
+        hi_ = Point(std::max(hi_.x, vertex.x), std::max(hi_.y, vertex.y));
+    }
+}
+
+double RegularPolygon::area() const {
+    return area_;
 }
 
 void RegularPolygon::print(std::ostream& os) const {
@@ -53,6 +114,7 @@ void RegularPolygon::print(std::ostream& os) const {
 
 void RegularPolygon::read(std::istream& is) {
     vertices.clear();
+    updateCache();
     std::string line;
     
     std::cout << "Введите " << sides << " вершин (x y для каждой):" << std::endl;
@@ -69,18 +131,70 @@ void RegularPolygon::read(std::istream& is) {
         if (iss.fail() || iss.get(extra)) {
             std::cout << "Ошибка: для вершины нужно ровно два числа!" << std::endl;
             is.setstate(std::ios::failbit);
+            updateCache();
             return;
         }
         
         vertices.push_back(Point(x, y));
     }
-    calculateCenter();
+    updateCache();
 }
 
 Point RegularPolygon::center() const {
     return center_;
 }
 
+void RegularPolygon::bounds(Point& lo, Point& hi) const {
+    lo = lo_;
+    hi = hi_;
+}
+
+bool RegularPolygon::contains(const Point& p) const {
+    if (vertices.size() < 3) return false;
+    if (p.x < lo_.x || p.x > hi_.x || p.y < lo_.y || p.y > hi_.y) return false;
+    // Метод лучей: считаем пересечения горизонтального луча из точки с рёбрами.
+    bool inside = false;
+    size_t n = vertices.size();
+    for (size_t i = 0, j = n - 1; i < n; j = i++) {
+        const Point& a = vertices[i];
+        const Point& b = vertices[j];
+        if ((a.y > p.y) != (b.y > p.y)) {
+            double x = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+            if (p.x < x) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+bool RegularPolygon::intersects(const Point& lo, const Point& hi) const {
+    if (vertices.empty()) return false;
+    if (hi_.x < lo.x || lo_.x > hi.x || hi_.y < lo.y || lo_.y > hi.y) return false;
+    for (const auto& v : vertices) {
+        if (v.x >= lo.x && v.x <= hi.x && v.y >= lo.y && v.y <= hi.y) return true;
+    }
+    const Point corners[4] = {lo, Point(hi.x, lo.y), hi, Point(lo.x, hi.y)};
+    for (const auto& c : corners) {
+        if (contains(c)) return true;
+    }
+    auto cross = [](const Point& o, const Point& a, const Point& b) {
+        return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+    };
+    auto segmentsCross = [&](const Point& p1, const Point& p2, const Point& q1, const Point& q2) {
+        double d1 = cross(q1, q2, p1), d2 = cross(q1, q2, p2);
+        double d3 = cross(p1, p2, q1), d4 = cross(p1, p2, q2);
+        return ((d1 > 0) != (d2 > 0)) && ((d3 > 0) != (d4 > 0));
+    };
+    size_t n = vertices.size();
+    for (size_t i = 0; i < n; ++i) {
+        const Point& a = vertices[i];
+        const Point& b = vertices[(i + 1) % n];
+        for (int k = 0; k < 4; ++k) {
+            if (segmentsCross(a, b, corners[k], corners[(k + 1) % 4])) return true;
+        }
+    }
+    return false;
+}
+
 // Pentagon
 Pentagon::Pentagon(const std::vector<Point>& vertices) 
     : RegularPolygon(vertices) {
@@ -136,7 +250,10 @@ std::istream& operator>>(std::istream& is, Figure& figure) {
     return is;
 }
 void FigureArray::addFigure(std::shared_ptr<Figure> figure) {
-    figures.push_back(figure);
+    figures.push_back(std::move(figure));
+}
+void FigureArray::reserve(size_t count) {
+    figures.reserve(count);
 }
 void FigureArray::removeFigure(int index) {
     if (index >= 0 && index < static_cast<int>(figures.size())) {
@@ -145,17 +262,45 @@ void FigureArray::removeFigure(int index) {
         std::cout << "Ошибка: индекс " << index << " вне диапазона!" << std::endl;
     }
 }
+void FigureArray::removeFigureUnordered(int index) {
+    if (index >= 0 && index < static_cast<int>(figures.size())) {
+        if (index != static_cast<int>(figures.size()) - 1) {
+            figures[index] = std::move(figures.back());
+        }
+        figures.pop_back();
+    } else {
+        std::cout << "Ошибка: индекс " << index << " вне диапазона!" << std::endl;
+    }
+}
 void FigureArray::printAll() const {
     for (size_t i = 0; i < figures.size(); ++i) {
         std::cout << "Фигура " << i << ": " << *figures[i] << std::endl;
     }
 }
 double FigureArray::totalArea() const {
-    double total = 0;
-    for (const auto& figure : figures) {
-        total += figure->area();
-    }
-    return total;
+    return common::total_area(figures.size(), [&](size_t i) { return figures[i]->area(); });
+}
+FigureStats FigureArray::stats(unsigned threads) const {
+    FigureStats result;
+    if (figures.empty()) return result;
+
+    PartialStats total = common::reduce_stats(figures.size(), threads, kMinFiguresPerThread,
+        [&](size_t i, PartialStats& local) {
+            const Figure& figure = *figures[i];
+            Point c = figure.center();
+            Point lo, hi;
+            figure.bounds(lo, hi);
+            local.add(figure.area(), c.x, c.y);
+            local.add_box(lo.x, lo.y, hi.x, hi.y);
+        });
+    result.count = total.count;
+    result.totalArea = total.area.value();
+    result.minArea = total.min_area;
+    result.maxArea = total.max_area;
+    result.lo = Point(total.min_x, total.min_y);
+    result.hi = Point(total.max_x, total.max_y);
+    result.meanCenter = Point(total.cx.value() / total.count, total.cy.value() / total.count);
+    return result;
 }
 std::shared_ptr<Figure> FigureArray::operator[](size_t index) const {
     if (index < figures.size()) {
@@ -165,4 +310,285 @@ std::shared_ptr<Figure> FigureArray::operator[](size_t index) const {
 }
 size_t FigureArray::size() const {
     return figures.size();
-}
\ No newline at end of file
+}
+size_t FigureStore::groupFor(size_t sides) {
+    for (size_t g = 0; g < groups.size(); ++g) {
+        if (groups[g].sides == sides) return g;
+    }
+    groups.emplace_back();
+    Group& group = groups.back();
+    group.sides = sides;
+    group.xs.resize(sides);
+    group.ys.resize(sides);
+    return groups.size() - 1;
+}
+void FigureStore::addFigure(const std::vector<Point>& vertices) {
+    size_t g = groupFor(vertices.size());
+    Group& group = groups[g];
+    for (size_t v = 0; v < vertices.size(); ++v) {
+        group.xs[v].push_back(vertices[v].x);
+        group.ys[v].push_back(vertices[v].y);
+    }
+    group.ids.push_back(figureCount++);
+}
+void FigureStore::addFigure(const RegularPolygon& polygon) {
+    addFigure(polygon.getVertices());
+}
+void FigureStore::clear() {
+    groups.clear();
+    figureCount = 0;
+}
+void FigureStore::groupAreas(const Group& group, Column& out) {
+    const size_t m = group.count();
+    const size_t n = group.sides;
+    out.assign(m, 0.0);
+    if (n < 3) return;
+    double* acc = out.data();
+    // Формула шнуровки по колонкам: внутренний цикл идёт по фигурам и векторизуется.
+    for (size_t v = 0; v < n; ++v) {
+        const size_t w = (v + 1 == n) ? 0 : v + 1;
+        const double* x0 = group.xs[v].data();
+        const double* y0 = group.ys[v].data();
+        const double* x1 = group.xs[w].data();
+        const double* y1 = group.ys[w].data();
+        for (size_t f = 0; f < m; ++f) {
+            acc[f] += x0[f] * y1[f] - x1[f] * y0[f];
+        }
+    }
+    for (size_t f = 0; f < m; ++f) {
+        acc[f] = std::abs(acc[f]) * 0.5;
+    }
+}
+double FigureStore::totalArea() const {
+    double total = 0;
+    Column acc;
+    for (const auto& group : groups) {
+        groupAreas(group, acc);
+        for (double a : acc) total += a;
+    }
+    return total;
+}
+void FigureStore::areas(std::vector<double>& out) const {
+    out.assign(figureCount, 0.0);
+    Column acc;
+    for (const auto& group : groups) {
+        groupAreas(group, acc);
+        for (size_t f = 0; f < group.count(); ++f) {
+            out[group.ids[f]] = acc[f];
+        }
+    }
+}
+void FigureStore::centers(std::vector<Point>& out) const {
+    out.assign(figureCount, Point());
+    Column cx, cy;
+    for (const auto& group : groups) {
+        const size_t m = group.count();
+        const size_t n = group.sides;
+        cx.assign(m, 0.0);
+        cy.assign(m, 0.0);
+        for (size_t v = 0; v < n; ++v) {
+            const double* xs = group.xs[v].data();
+            const double* ys = group.ys[v].data();
+            for (size_t f = 0; f < m; ++f) {
+                cx[f] += xs[f];
+                cy[f] += ys[f];
+            }
+        }
+        const double inv = n > 0 ? 1.0 / n : 0.0;
+        for (size_t f = 0; f < m; ++f) {
+            out[group.ids[f]] = Point(cx[f] * inv, cy[f] * inv);
+        }
+    }
+}
+
+void FigureIndex::build(const FigureArray& source) {
+    items.clear();
+    nodes.clear();
+    figures.clear();
+    figures.reserve(source.size());
+    items.reserve(source.size());
+    for (size_t i = 0; i < source.size(); ++i) {
+        figures.push_back(source[i]);
+        Point lo, hi;
+        figures.back()->bounds(lo, hi);
+        items.push_back(Item{Box{lo.x, lo.y, hi.x, hi.y}, i});
+    }
+    if (items.empty()) return;
+
+    // Sort-Tile-Recursive: сортируем по x, режем на вертикальные полосы,
+    // внутри полосы сортируем по y и упаковываем группами по kNodeCapacity.
+    auto strSort = [](auto begin, auto end, auto boxOf) {
+        size_t n = end - begin;
+        size_t groups = (n + kNodeCapacity - 1) / kNodeCapacity;
+        size_t slices = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(groups))));
+        size_t perSlice = slices * kNodeCapacity;
+        auto centerX = [&](const auto& e) { const Box& b = boxOf(e); return b.minX + b.maxX; };
+        auto centerY = [&](const auto& e) { const Box& b = boxOf(e); return b.minY + b.maxY; };
+        std::sort(begin, end, [&](const auto& a, const auto& b) { return centerX(a) < centerX(b); });
+        for (size_t s = 0; s < n; s += perSlice) {
+            auto sliceEnd = begin + std::min(n, s + perSlice);
+            std::sort(begin + s, sliceEnd, [&](const auto& a, const auto& b) { return centerY(a) < centerY(b); });
+        }
+    };
+    auto merge = [](Box& into, const Box& b) {
+        into.minX = std::min(into.minX, b.minX);
+        into.minY = std::min(into.minY, b.minY);
+        into.maxX = std::max(into.maxX, b.maxX);
+        into.maxY = std::max(into.maxY, b.maxY);
+    };
+
+    strSort(items.begin(), items.end(), [](const Item& e) -> const Box& { return e.box; });
+    std::vector<Node> level;
+    for (size_t i = 0; i < items.size(); i += kNodeCapacity) {
+        Node node{items[i].box, i, std::min(kNodeCapacity, items.size() - i), true};
+        for (size_t k = i + 1; k < i + node.count; ++k) merge(node.box, items[k].box);
+        level.push_back(node);
+    }
+    while (true) {
+        if (level.size() > 1) {
+            strSort(level.begin(), level.end(), [](const Node& e) -> const Box& { return e.box; });
+        }
+        size_t base = nodes.size();
+        nodes.insert(nodes.end(), level.begin(), level.end());
+        if (level.size() == 1) break;
+
+        std::vector<Node> parents;
+        for (size_t i = 0; i < level.size(); i += kNodeCapacity) {
+            Node node{level[i].box, base + i, std::min(kNodeCapacity, level.size() - i), false};
+            for (size_t k = i + 1; k < i + node.count; ++k) merge(node.box, level[k].box);
+            parents.push_back(node);
+        }
+        level.swap(parents);
+    }
+}
+
+template <typename Visit>
+void FigureIndex::query(const Box& window, Visit&& visit) const {
+    if (nodes.empty()) return;
+    // Глубина дерева не превышает 32 уровней, на каждом в стек попадает не больше kNodeCapacity узлов.
+    size_t stack[kNodeCapacity * 32];
+    size_t top = 0;
+    stack[top++] = nodes.size() - 1;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (!node.box.overlaps(window)) continue;
+        if (node.leaf) {
+            for (size_t k = node.first; k < node.first + node.count; ++k) {
+                if (items[k].box.overlaps(window)) visit(items[k].id);
+            }
+        } else {
+            for (size_t k = node.first; k < node.first + node.count; ++k) {
+                stack[top++] = k;
+            }
+        }
+    }
+}
+
+std::vector<size_t> FigureIndex::containing(const Point& p) const {
+    std::vector<size_t> result;
+    query(Box{p.x, p.y, p.x, p.y}, [&](size_t id) {
+        if (figures[id]->contains(p)) result.push_back(id);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<size_t> FigureIndex::intersecting(const Point& lo, const Point& hi) const {
+    std::vector<size_t> result;
+    query(Box{lo.x, lo.y, hi.x, hi.y}, [&](size_t id) {
+        if (figures[id]->intersects(lo, hi)) result.push_back(id);
+    });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void FigureIndex::containingBatch(const std::vector<Point>& points,
+                                  std::vector<std::vector<size_t>>& out) const {
+    out.resize(points.size());
+    for (auto& ids : out) ids.clear();
+    if (nodes.empty() || points.empty()) return;
+
+    // Точки сортируются по x один раз; в каждый узел спускается только
+    // подмножество точек, попавших в его рамку, так что узел проверяется
+    // один раз на весь пакет, а не на каждую точку. Подмножество остаётся
+    // отсортированным по x, и полоса по x находится двоичным поиском.
+    std::vector<size_t> order(points.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return points[a].x < points[b].x; });
+
+    size_t height = 1;
+    for (size_t n = nodes.size() - 1; !nodes[n].leaf; n = nodes[n].first) ++height;
+    std::vector<std::vector<size_t>> scratch(height);   // по буферу на уровень дерева
+    auto descend = [&](auto& self, size_t index, const size_t* first, const size_t* last, size_t depth) -> void {
+        const Node& node = nodes[index];
+        first = std::lower_bound(first, last, node.box.minX,
+                                 [&](size_t i, double x) { return points[i].x < x; });
+        last = std::upper_bound(first, last, node.box.maxX,
+                                [&](double x, size_t i) { return x < points[i].x; });
+        if (first == last) return;
+        std::vector<size_t>& inside = scratch[depth];
+        inside.clear();
+        for (const size_t* it = first; it != last; ++it) {
+            double y = points[*it].y;
+            if (node.box.minY <= y && y <= node.box.maxY) inside.push_back(*it);
+        }
+        if (inside.empty()) return;
+        if (node.leaf) {
+            for (size_t k = node.first; k < node.first + node.count; ++k) {
+                const Box& box = items[k].box;
+                const Figure& figure = *figures[items[k].id];
+                for (size_t i : inside) {
+                    const Point& p = points[i];
+                    if (p.x < box.minX || p.x > box.maxX || p.y < box.minY || p.y > box.maxY) continue;
+                    if (figure.contains(p)) out[i].push_back(items[k].id);
+                }
+            }
+            return;
+        }
+        const size_t* begin = inside.data();
+        const size_t* end = begin + inside.size();
+        for (size_t k = node.first; k < node.first + node.count; ++k) {
+            self(self, k, begin, end, depth + 1);
+        }
+    };
+    descend(descend, nodes.size() - 1, order.data(), order.data() + order.size(), 0);
+
+    for (auto& ids : out) std::sort(ids.begin(), ids.end());
+}
+
+size_t loadFigures(const std::string& path, FigureArray& out) {
+    MappedFile file(path);
+    std::vector<std::shared_ptr<Figure>> parsed;
+    auto emit = [&](int type, const double* coords, size_t sides) {
+        parsed.push_back(makeFigure(type, coords, sides));
+    };
+    size_t loaded;
+    if (common::has_figure_magic(file.data(), file.size(), kBinaryMagic)) {
+        loaded = common::parse_figures_binary(file.data(), file.size(), sidesForType, emit);
+    } else {
+        loaded = common::parse_figures_text<double>(file.data(), file.data() + file.size(), sidesForType, emit);
+    }
+    appendAll(parsed, out);
+    return loaded;
+}
+void saveFiguresBinary(const std::string& path, const FigureArray& figures) {
+    std::vector<unsigned char> types;
+    std::vector<double> coords;
+    types.reserve(figures.size());
+    for (size_t i = 0; i < figures.size(); ++i) {
+        auto polygon = std::dynamic_pointer_cast<RegularPolygon>(figures[i]);
+        if (!polygon) throw std::runtime_error("Фигуру нельзя сохранить в бинарный формат");
+        const auto& vertices = polygon->getVertices();
+        unsigned char type = 0;
+        for (int t = 1; t <= 3; ++t) {
+            if (sidesForType(t) == vertices.size()) type = t;
+        }
+        if (type == 0) throw std::runtime_error("Фигуру нельзя сохранить в бинарный формат");
+        types.push_back(type);
+        for (const auto& vertex : vertices) {
+            coords.push_back(vertex.x);
+            coords.push_back(vertex.y);
+        }
+    }
+    common::write_figures_binary(path, kBinaryMagic, types, coords);
+}
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <memory>
 #include <limits>
+#include <string>
 
 
 int main() {
@@ -83,6 +84,18 @@ do {
                 }
                 break;
             }
+            case 7: {
+                std::cout << "Введите путь к файлу: ";
+                std::string path;
+                std::cin >> path;
+                try {
+                    size_t loaded = loadFigures(path, figures);
+                    std::cout << "Загружено фигур: " << loaded << std::endl;
+                } catch (const std::exception& e) {
+                    std::cout << "Ошибка загрузки: " << e.what() << std::endl;
+                }
+                break;
+            }
             case 0: {
                 break;
             }
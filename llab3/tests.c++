@@ -3,6 +3,8 @@
 #include <sstream>
 #include <vector>
 #include <cmath>
+#include <fstream>
+#include <stdexcept>
 
 // Вспомогательная функция для создания правильного пятиугольника
 std::vector<Point> createRegularPentagon(Point center, double radius) {
@@ -97,6 +99,31 @@ TEST(FigureArrayTest, AddAndRemove) {
     EXPECT_TRUE(output.find("Ошибка") != std::string::npos);
 }
 
+TEST(FigureArrayTest, RemoveUnordered) {
+    FigureArray array;
+    auto a = std::make_shared<Pentagon>(createRegularPentagon(Point(0, 0), 1.0));
+    auto b = std::make_shared<Hexagon>(createRegularHexagon(Point(1, 1), 2.0));
+    auto c = std::make_shared<Octagon>(createRegularOctagon(Point(2, 2), 3.0));
+    array.addFigure(a);
+    array.addFigure(b);
+    array.addFigure(c);
+
+    array.removeFigureUnordered(0);
+    ASSERT_EQ(array.size(), 2);
+    EXPECT_EQ(array[0], c);
+    EXPECT_EQ(array[1], b);
+
+    array.removeFigureUnordered(1);
+    ASSERT_EQ(array.size(), 1);
+    EXPECT_EQ(array[0], c);
+
+    testing::internal::CaptureStdout();
+    array.removeFigureUnordered(3);
+    std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_TRUE(output.find("Ошибка") != std::string::npos);
+    EXPECT_EQ(array.size(), 1);
+}
+
 TEST(FigureArrayTest, TotalArea) {
     FigureArray array;
     
@@ -176,6 +203,206 @@ TEST(FigureArrayTest, IndexOperator) {
     EXPECT_EQ(invalid_figure, nullptr);
 }
 
+TEST(FigureArrayTest, ParallelStats) {
+    FigureArray array;
+    double expectedTotal = 0;
+    for (int i = 0; i < 1000; ++i) {
+        auto hexagon = std::make_shared<Hexagon>(createRegularHexagon(Point(i, -i), 1.0 + i % 7));
+        expectedTotal += hexagon->area();
+        array.addFigure(hexagon);
+    }
+    array.addFigure(std::make_shared<RegularPolygon>(std::vector<Point>{
+        Point(0, 0), Point(1e-3, 0), Point(0, 1e-3)}));
+    expectedTotal += 0.5e-6;
+
+    FigureStats one = array.stats(1);
+    FigureStats four = array.stats(4);
+    EXPECT_EQ(one.count, 1001);
+    EXPECT_EQ(four.count, 1001);
+    EXPECT_NEAR(one.totalArea, expectedTotal, 1e-9);
+    EXPECT_NEAR(four.totalArea, one.totalArea, 1e-9);
+    EXPECT_NEAR(array.totalArea(), one.totalArea, 1e-9);
+    EXPECT_NEAR(four.minArea, 0.5e-6, 1e-12);
+    EXPECT_NEAR(four.maxArea, 0.5 * 6 * 49 * sin(2 * 3.1415 / 6), 0.01);
+    EXPECT_NEAR(four.lo.x, -1.0, 1e-3);
+    EXPECT_NEAR(four.hi.x, 999 + 1.0 + 999 % 7, 1e-3);
+    EXPECT_NEAR(four.meanCenter.x, one.meanCenter.x, 1e-9);
+    EXPECT_NEAR(four.meanCenter.y, one.meanCenter.y, 1e-9);
+
+    FigureStats empty = FigureArray().stats();
+    EXPECT_EQ(empty.count, 0);
+    EXPECT_EQ(empty.totalArea, 0);
+}
+
+TEST(LoaderTest, TextFormat) {
+    std::string path = testing::TempDir() + "figures.txt";
+    {
+        std::ofstream out(path);
+        out << "# тип и координаты\n"
+            << "1 0 0, 4 0, 4 4, 2 6, 0 4\n"
+            << "\n"
+            << "2;1;0;0.5;0.866;-0.5;0.866;-1;0;-0.5;-0.866;0.5;-0.866\r\n"
+            << "3 1 0 0.7071 0.7071 0 1 -0.7071 0.7071 -1 0 -0.7071 -0.7071 0 -1 0.7071 -0.7071  # восьмиугольник";
+    }
+    FigureArray array;
+    EXPECT_EQ(loadFigures(path, array), 3);
+    ASSERT_EQ(array.size(), 3);
+    EXPECT_NE(std::dynamic_pointer_cast<Pentagon>(array[0]), nullptr);
+    EXPECT_NE(std::dynamic_pointer_cast<Hexagon>(array[1]), nullptr);
+    EXPECT_NE(std::dynamic_pointer_cast<Octagon>(array[2]), nullptr);
+    EXPECT_NEAR(array[0]->area(), 20.0, 1e-9);
+    EXPECT_NEAR(array[1]->area(), 0.5 * 6 * sin(2 * M_PI / 6), 0.01);
+
+    {
+        std::ofstream out(path);
+        out << "2;1;0;0.5;0.866;-0.5;0.866;-1;0;-0.5;-0.866;0.5;-0.866\n"
+            << "1 0 0 1 1\n";
+    }
+    FigureArray broken;
+    EXPECT_THROW(loadFigures(path, broken), std::runtime_error);
+    EXPECT_EQ(broken.size(), 0);
+    EXPECT_THROW(loadFigures(path + ".missing", broken), std::runtime_error);
+}
+
+TEST(LoaderTest, BinaryRoundTrip) {
+    FigureArray array;
+    for (int i = 0; i < 50; ++i) {
+        array.addFigure(std::make_shared<Pentagon>(createRegularPentagon(Point(i, 0), 1.0)));
+        array.addFigure(std::make_shared<Octagon>(createRegularOctagon(Point(0, i), 2.0)));
+    }
+    array.addFigure(std::make_shared<Hexagon>(createRegularHexagon(Point(-3, 3), 0.5)));
+
+    std::string path = testing::TempDir() + "figures.bin";
+    saveFiguresBinary(path, array);
+
+    FigureArray loaded;
+    EXPECT_EQ(loadFigures(path, loaded), array.size());
+    ASSERT_EQ(loaded.size(), array.size());
+    for (size_t i = 0; i < array.size(); ++i) {
+        EXPECT_DOUBLE_EQ(loaded[i]->area(), array[i]->area());
+        EXPECT_DOUBLE_EQ(loaded[i]->center().x, array[i]->center().x);
+    }
+    EXPECT_NE(std::dynamic_pointer_cast<Hexagon>(loaded[100]), nullptr);
+
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        out.write("FIG1\0\0\0\0\x05\0\0\0\0\0\0\0\x01", 17);
+    }
+    FigureArray truncated;
+    EXPECT_THROW(loadFigures(path, truncated), std::runtime_error);
+}
+
+TEST(FigureIndexTest, MatchesLinearScan) {
+    FigureArray array;
+    for (int i = 0; i < 40; ++i) {
+        for (int j = 0; j < 40; ++j) {
+            double x = i * 3, y = j * 3;
+            array.addFigure(std::make_shared<RegularPolygon>(std::vector<Point>{
+                Point(x, y), Point(x + 2, y), Point(x + 2, y + 2), Point(x, y + 2)}));
+        }
+    }
+    array.addFigure(std::make_shared<Hexagon>(createRegularHexagon(Point(10, 10), 8.0)));
+    FigureIndex index(array);
+    EXPECT_EQ(index.size(), array.size());
+
+    auto hits = index.containing(Point(6.5, 6.5));
+    ASSERT_EQ(hits.size(), 2);
+    EXPECT_EQ(hits[0], 2 * 40 + 2);
+    EXPECT_EQ(hits[1], 1600);
+    EXPECT_TRUE(index.containing(Point(-5, -5)).empty());
+
+    std::vector<Point> queries;
+    for (int k = 0; k < 200; ++k) {
+        queries.push_back(Point((k * 37 % 1200) / 10.0, (k * 91 % 1200) / 10.0));
+    }
+    std::vector<std::vector<size_t>> batch;
+    index.containingBatch(queries, batch);
+    ASSERT_EQ(batch.size(), queries.size());
+    for (size_t q = 0; q < queries.size(); ++q) {
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < array.size(); ++i) {
+            if (array[i]->contains(queries[q])) expected.push_back(i);
+        }
+        EXPECT_EQ(batch[q], expected);
+    }
+    // Повторный вызов с меньшим пакетом не оставляет старых результатов.
+    std::vector<Point> few(queries.begin(), queries.begin() + 3);
+    index.containingBatch(few, batch);
+    ASSERT_EQ(batch.size(), few.size());
+    for (size_t q = 0; q < few.size(); ++q) {
+        EXPECT_EQ(batch[q], index.containing(few[q]));
+    }
+
+    for (int k = 0; k < 50; ++k) {
+        Point lo((k * 13 % 110), (k * 29 % 110));
+        Point hi(lo.x + 0.5 + k % 7, lo.y + 0.5 + k % 5);
+        std::vector<size_t> expected;
+        for (size_t i = 0; i < array.size(); ++i) {
+            if (array[i]->intersects(lo, hi)) expected.push_back(i);
+        }
+        EXPECT_EQ(index.intersecting(lo, hi), expected);
+    }
+
+    auto window = index.intersecting(Point(8.2, 8.2), Point(8.8, 8.8));
+    ASSERT_EQ(window.size(), 1);
+    EXPECT_EQ(window[0], 1600);
+
+    FigureIndex empty(FigureArray{});
+    EXPECT_TRUE(empty.containing(Point(0, 0)).empty());
+}
+
+TEST(CacheTest, ReadInvalidatesAreaAndCenter) {
+    std::vector<Point> square_vertices = {
+        Point(0, 0), Point(2, 0), Point(2, 2), Point(0, 2)
+    };
+    RegularPolygon square(square_vertices);
+    EXPECT_NEAR(square.area(), 4.0, 1e-9);
+
+    Pentagon pentagon(createRegularPentagon(Point(0, 0), 1.0));
+    double before = pentagon.area();
+
+    std::istringstream input("0 0\n4 0\n4 4\n2 6\n0 4\n");
+    testing::internal::CaptureStdout();
+    input >> pentagon;
+    testing::internal::GetCapturedStdout();
+
+    ASSERT_FALSE(input.fail());
+    EXPECT_NE(pentagon.area(), before);
+    EXPECT_NEAR(pentagon.area(), 20.0, 1e-9);
+    EXPECT_NEAR(pentagon.center().x, 2.0, 1e-9);
+    EXPECT_NEAR(pentagon.center().y, 2.8, 1e-9);
+}
+
+TEST(FigureStoreTest, MatchesFigureArray) {
+    FigureArray array;
+    FigureStore store;
+    for (int i = 0; i < 10; ++i) {
+        auto pentagon = std::make_shared<Pentagon>(createRegularPentagon(Point(i, -i), 1.0 + i));
+        auto hexagon = std::make_shared<Hexagon>(createRegularHexagon(Point(-i, i), 0.5 + i));
+        auto octagon = std::make_shared<Octagon>(createRegularOctagon(Point(i, i), 2.0));
+        for (auto& fig : std::vector<std::shared_ptr<RegularPolygon>>{pentagon, hexagon, octagon}) {
+            array.addFigure(fig);
+            store.addFigure(*fig);
+        }
+    }
+    ASSERT_EQ(store.size(), array.size());
+    EXPECT_NEAR(store.totalArea(), array.totalArea(), 1e-9);
+
+    std::vector<double> areas;
+    std::vector<Point> centers;
+    store.areas(areas);
+    store.centers(centers);
+    for (size_t i = 0; i < array.size(); ++i) {
+        EXPECT_NEAR(areas[i], array[i]->area(), 1e-9);
+        EXPECT_NEAR(centers[i].x, array[i]->center().x, 1e-9);
+        EXPECT_NEAR(centers[i].y, array[i]->center().y, 1e-9);
+    }
+
+    store.clear();
+    EXPECT_EQ(store.size(), 0);
+    EXPECT_EQ(store.totalArea(), 0.0);
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
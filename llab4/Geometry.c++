@@ -1,102 +1,252 @@
 #include "Geometry.h"
+#include "common/figure_format.h"
+#include "common/mapped_file.h"
+#include "common/stats.h"
 #include <stdexcept>
 #include <iostream>
+#include <cstdint>
+#include <limits>
+
+namespace {
+
+constexpr size_t kMinFiguresPerThread = 4096;
+
+constexpr char kBinaryMagic[4] = {'F', 'I', 'G', '4'};
+
+using common::MappedFile;
+
+// Число вершин для типа фигуры из меню; 0 — неизвестный тип.
+constexpr size_t vertices_for_type(int type) {
+    switch (type) {
+        case 1: return 4;
+        case 2: return 4;
+        case 3: return 5;
+        default: return 0;
+    }
+}
 
 template <ScalarType T>
-Figure<T>::Figure(const Figure& other) {
-    this->vertices.reserve(other.vertices.size());
-    for (const auto& point_ptr : other.vertices) {
-        this->vertices.emplace_back(std::make_unique<Point<T>>(*point_ptr));
+std::shared_ptr<Figure<T>> make_figure(int type, const T* c) {
+    switch (type) {
+        case 1: return std::make_shared<Trapezoid<T>>(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]);
+        case 2: return std::make_shared<Rhombus<T>>(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7]);
+        default: return std::make_shared<Pentagon<T>>(c[0], c[1], c[2], c[3], c[4], c[5], c[6], c[7], c[8], c[9]);
     }
 }
+
+// Можно ли привести double к T без неопределённого поведения (дробная часть отбрасывается).
 template <ScalarType T>
-Point<T> Figure<T>::center() const {
-    T sum_x = 0;
-    T sum_y = 0;
-    for (const auto& p : this->vertices) {
-        sum_x += p->x;
-        sum_y += p->y;
+bool representable_as(double v) {
+    if constexpr (std::is_integral_v<T>) {
+        return std::isfinite(v) &&
+               v > static_cast<double>(std::numeric_limits<T>::min()) - 1.0 &&
+               v < static_cast<double>(std::numeric_limits<T>::max()) + 1.0;
+    } else {
+        return !std::isfinite(v) || std::abs(v) <= static_cast<double>(std::numeric_limits<T>::max());
     }
-    size_t n = this->vertices.size();
-    if (n == 0) return Point<T>{};
-    return Point<T>{sum_x / static_cast<T>(n), sum_y / static_cast<T>(n)};
 }
 
+using common::PartialStats;
+
+}
+
+template <ScalarType T>
+Point<T> Figure<T>::center() const {
+    return cached_center;
+}
+
+template <class T>
+Array<T>::Array(const Array& other) : growth_factor(other.growth_factor) {
+    if (other.size == 0) return;
+    T* fresh = std::allocator<T>().allocate(other.size);
+    try {
+        std::uninitialized_copy_n(other.items, other.size, fresh);
+    } catch (...) {
+        std::allocator<T>().deallocate(fresh, other.size);
+        throw;
+    }
+    items = fresh;
+    size = capacity = other.size;
+}
+template <class T>
+Array<T>& Array<T>::operator=(const Array& other) {
+    if (this != &other) {
+        *this = Array(other);
+    }
+    return *this;
+}
+template <class T>
+Array<T>::Array(Array&& other) noexcept
+    : items(std::exchange(other.items, nullptr)),
+      size(std::exchange(other.size, 0)),
+      capacity(std::exchange(other.capacity, 0)),
+      growth_factor(other.growth_factor) {}
 template <class T>
-void Array<T>::resize(size_t new_capacity) {
-    if (new_capacity <= capacity) return;
-    std::shared_ptr<T[]> new_data = std::shared_ptr<T[]>(new T[new_capacity]);
-    for (size_t i = 0; i < size; ++i) {
-        new_data[i] = std::move(data[i]);
+Array<T>& Array<T>::operator=(Array&& other) noexcept {
+    if (this != &other) {
+        release();
+        items = std::exchange(other.items, nullptr);
+        size = std::exchange(other.size, 0);
+        capacity = std::exchange(other.capacity, 0);
+        growth_factor = other.growth_factor;
     }
-    data = std::move(new_data); 
+    return *this;
+}
+template <class T>
+void Array<T>::release() {
+    if (items) {
+        std::destroy_n(items, size);
+        std::allocator<T>().deallocate(items, capacity);
+    }
+    items = nullptr;
+    size = capacity = 0;
+}
+template <class T>
+size_t Array<T>::next_capacity(size_t min_capacity) const {
+    size_t grown = static_cast<size_t>(std::ceil(capacity * growth_factor));
+    return std::max({min_capacity, grown, size_t(1)});
+}
+template <class T>
+void Array<T>::reallocate(size_t new_capacity) {
+    T* fresh = std::allocator<T>().allocate(new_capacity);
+    std::uninitialized_move_n(items, size, fresh);
+    size_t n = size;
+    release();
+    items = fresh;
+    size = n;
     capacity = new_capacity;
 }
 template <class T>
-void Array<T>::push_back(T item) {
-    if (size == capacity) {
-        resize(capacity == 0 ? 1 : capacity * 2); 
+void Array<T>::reserve(size_t new_capacity) {
+    if (new_capacity > capacity) {
+        reallocate(new_capacity);
+    }
+}
+template <class T>
+void Array<T>::set_growth_factor(double factor) {
+    if (!(factor > 1.0)) {
+        throw std::invalid_argument("Growth factor must be greater than 1");
     }
-    data[size++] = std::move(item); 
+    growth_factor = factor;
+}
+template <class T>
+void Array<T>::push_back(T item) {
+    emplace_back(std::move(item));
 }
 template <class T>
 void Array<T>::remove_at(size_t index) {
     if (index >= size) {
         throw std::out_of_range("Index out of bounds");
     }
-    for (size_t i = index; i < size - 1; ++i) {
-        data[i] = std::move(data[i + 1]); 
+    std::move(items + index + 1, items + size, items + index);
+    std::destroy_at(items + size - 1);
+    --size;
+}
+template <class T>
+void Array<T>::swap_remove_at(size_t index) {
+    if (index >= size) {
+        throw std::out_of_range("Index out of bounds");
+    }
+    size_t last = size - 1;
+    if (index != last) {
+        items[index] = std::move(items[last]);
     }
-    size--;
+    std::destroy_at(items + last);
+    --size;
 }
 template <class T>
 T& Array<T>::operator[](size_t index) {
     if (index >= size) {
         throw std::out_of_range("Index out of bounds");
     }
-    return data[index];
+    return items[index];
 }
 template <class T>
 const T& Array<T>::operator[](size_t index) const {
     if (index >= size) {
         throw std::out_of_range("Index out of bounds");
     }
-    return data[index];
+    return items[index];
 }
-template <ScalarType T>
-double calculate_polygon_area(const std::vector<typename Figure<T>::PointPtr>& vertices) {
-    size_t n = vertices.size();
-    if (n < 3) return 0.0;
-    double area_val = 0.0;
-    
-    for (size_t i = 0; i < n; ++i) {
-        const Point<T>& p1 = *vertices[i];
-        const Point<T>& p2 = *vertices[(i + 1) % n]; 
-        area_val += (static_cast<double>(p1.x) * static_cast<double>(p2.y) - 
-                    static_cast<double>(p2.x) * static_cast<double>(p1.y));
+template <class T>
+typename SlotMap<T>::Handle SlotMap<T>::insert(T item) {
+    uint32_t slot_index;
+    if (free_head != UINT32_MAX) {
+        slot_index = free_head;
+        free_head = slots[slot_index].target;
+    } else {
+        slot_index = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
     }
-    return std::abs(area_val) / 2.0;
+    Slot& slot = slots[slot_index];
+    slot.target = static_cast<uint32_t>(values.size());
+    slot.alive = true;
+    values.push_back(std::move(item));
+    owners.push_back(slot_index);
+    return Handle{slot_index, slot.generation};
+}
+template <class T>
+bool SlotMap<T>::contains(Handle handle) const {
+    return handle.index < slots.size() && slots[handle.index].alive &&
+           slots[handle.index].generation == handle.generation;
+}
+template <class T>
+bool SlotMap<T>::erase(Handle handle) {
+    if (!contains(handle)) return false;
+    Slot& slot = slots[handle.index];
+    uint32_t dense = slot.target;
+    uint32_t last = static_cast<uint32_t>(values.size() - 1);
+    if (dense != last) {
+        values[dense] = std::move(values[last]);
+        owners[dense] = owners[last];
+        slots[owners[dense]].target = dense;
+    }
+    values.pop_back();
+    owners.pop_back();
+    slot.alive = false;
+    ++slot.generation;
+    slot.target = free_head;
+    free_head = handle.index;
+    return true;
+}
+template <class T>
+T* SlotMap<T>::get(Handle handle) {
+    return contains(handle) ? &values[slots[handle.index].target] : nullptr;
+}
+template <class T>
+const T* SlotMap<T>::get(Handle handle) const {
+    return contains(handle) ? &values[slots[handle.index].target] : nullptr;
+}
+template <class T>
+T& SlotMap<T>::operator[](size_t index) {
+    if (index >= values.size()) {
+        throw std::out_of_range("Index out of bounds");
+    }
+    return values[index];
+}
+template <class T>
+const T& SlotMap<T>::operator[](size_t index) const {
+    if (index >= values.size()) {
+        throw std::out_of_range("Index out of bounds");
+    }
+    return values[index];
 }
 
 template <ScalarType T>
-Trapezoid<T>::Trapezoid(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4) {
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x1, y1));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x2, y2));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x3, y3));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x4, y4));
-}
+Trapezoid<T>::Trapezoid(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4)
+    : PolygonFigure<T, 4>({Point<T>(x1, y1), Point<T>(x2, y2), Point<T>(x3, y3), Point<T>(x4, y4)}) {}
 
 template <ScalarType T>
 Point<T> Trapezoid<T>::center() const { return Figure<T>::center(); }
 
 template <ScalarType T>
-double Trapezoid<T>::area() const { return calculate_polygon_area<T>(this->vertices); }
+double Trapezoid<T>::area() const { return this->cached_area; }
 
 template <ScalarType T>
 void Trapezoid<T>::print_coords() const {
     std::cout << "  Trapezoid coordinates: ";
     for (size_t i = 0; i < this->vertices.size(); ++i) {
-        std::cout << "(" << this->vertices[i]->x << ", " << this->vertices[i]->y << ") ";
+        std::cout << "(" << this->vertices[i].x << ", " << this->vertices[i].y << ") ";
     }
     std::cout << std::endl;
 }
@@ -107,22 +257,18 @@ bool Trapezoid<T>::operator==(const Figure<T>& other) const {
 }
 
 template <ScalarType T>
-Rhombus<T>::Rhombus(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4) : Figure<T>() {
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x1, y1));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x2, y2));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x3, y3));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x4, y4));
-}
+Rhombus<T>::Rhombus(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4)
+    : PolygonFigure<T, 4>({Point<T>(x1, y1), Point<T>(x2, y2), Point<T>(x3, y3), Point<T>(x4, y4)}) {}
 
 template <ScalarType T> 
 Point<T> Rhombus<T>::center() const { return Figure<T>::center(); } 
 template <ScalarType T> 
-double Rhombus<T>::area() const { return calculate_polygon_area<T>(this->vertices); }
+double Rhombus<T>::area() const { return this->cached_area; }
 template <ScalarType T> 
 void Rhombus<T>::print_coords() const { 
     std::cout << "  Rhombus coordinates: ";
     for (size_t i = 0; i < this->vertices.size(); ++i) {
-        std::cout << "(" << this->vertices[i]->x << ", " << this->vertices[i]->y << ") ";
+        std::cout << "(" << this->vertices[i].x << ", " << this->vertices[i].y << ") ";
     }
     std::cout << std::endl;
 }
@@ -133,23 +279,19 @@ bool Rhombus<T>::operator==(const Figure<T>& other) const {
 }
 
 template <ScalarType T>
-Pentagon<T>::Pentagon(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4, T x5, T y5) : Figure<T>() {
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x1, y1));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x2, y2));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x3, y3));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x4, y4));
-    this->vertices.emplace_back(std::make_unique<Point<T>>(x5, y5));
-}
+Pentagon<T>::Pentagon(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4, T x5, T y5)
+    : PolygonFigure<T, 5>({Point<T>(x1, y1), Point<T>(x2, y2), Point<T>(x3, y3),
+                           Point<T>(x4, y4), Point<T>(x5, y5)}) {}
 
 template <ScalarType T> 
 Point<T> Pentagon<T>::center() const { return Figure<T>::center(); } 
 template <ScalarType T> 
-double Pentagon<T>::area() const { return calculate_polygon_area<T>(this->vertices); }
+double Pentagon<T>::area() const { return this->cached_area; }
 template <ScalarType T> 
 void Pentagon<T>::print_coords() const { 
     std::cout << "  Pentagon coordinates: ";
     for (size_t i = 0; i < this->vertices.size(); ++i) {
-        std::cout << "(" << this->vertices[i]->x << ", " << this->vertices[i]->y << ") ";
+        std::cout << "(" << this->vertices[i].x << ", " << this->vertices[i].y << ") ";
     }
     std::cout << std::endl;
 }
@@ -159,6 +301,111 @@ bool Pentagon<T>::operator==(const Figure<T>& other) const {
     return std::abs(this->area() - other.area()) < 1e-6; 
 }
 
+template <ScalarType T>
+double total_area(const FigureVariantArray<T>& figures) {
+    double sum = 0.0;
+    for (size_t i = 0; i < figures.get_size(); ++i) {
+        sum += std::visit([](const auto& fig) { return fig.area(); }, figures[i]);
+    }
+    return sum;
+}
+
+template <ScalarType T>
+double total_area(const Array<std::shared_ptr<Figure<T>>>& figures) {
+    double sum = 0.0;
+    for (size_t i = 0; i < figures.get_size(); ++i) {
+        sum += figures[i]->area();
+    }
+    return sum;
+}
+
+template <ScalarType T>
+void print_all(const FigureVariantArray<T>& figures) {
+    for (size_t i = 0; i < figures.get_size(); ++i) {
+        std::visit([](const auto& fig) { fig.print_coords(); }, figures[i]);
+    }
+}
+
+template <ScalarType T>
+void print_all(const Array<std::shared_ptr<Figure<T>>>& figures) {
+    for (size_t i = 0; i < figures.get_size(); ++i) {
+        figures[i]->print_coords();
+    }
+}
+
+template <ScalarType T>
+FigureStats compute_stats(const Array<std::shared_ptr<Figure<T>>>& figures, unsigned threads) {
+    FigureStats result;
+    if (figures.get_size() == 0) return result;
+
+    PartialStats total = common::reduce_stats(figures.get_size(), threads, kMinFiguresPerThread,
+        [&](size_t i, PartialStats& local) {
+            const Figure<T>& figure = *figures[i];
+            Point<T> c = figure.center();
+            local.add(figure.area(), static_cast<double>(c.x), static_cast<double>(c.y));
+            for (const auto& p : figure.points()) {
+                double x = static_cast<double>(p.x);
+                double y = static_cast<double>(p.y);
+                local.add_box(x, y, x, y);
+            }
+        });
+    result.count = total.count;
+    result.total_area = total.area.value();
+    result.min_area = total.min_area;
+    result.max_area = total.max_area;
+    result.bbox_min = Point<double>(total.min_x, total.min_y);
+    result.bbox_max = Point<double>(total.max_x, total.max_y);
+    result.mean_center = Point<double>(total.cx.value() / total.count, total.cy.value() / total.count);
+    return result;
+}
+
+template <ScalarType T>
+size_t load_figures(const std::string& path, Array<std::shared_ptr<Figure<T>>>& out) {
+    MappedFile file(path);
+    // Фигуры копятся отдельно и попадают в out только если разобран весь файл.
+    std::vector<std::shared_ptr<Figure<T>>> parsed;
+    size_t loaded;
+    if (common::has_figure_magic(file.data(), file.size(), kBinaryMagic)) {
+        loaded = common::parse_figures_binary(file.data(), file.size(), vertices_for_type,
+            [&](int type, const double* raw, size_t n) {
+                T c[10];
+                for (size_t k = 0; k < 2 * n; ++k) {
+                    if (!representable_as<T>(raw[k])) throw std::runtime_error("Координата вне диапазона типа");
+                    c[k] = static_cast<T>(raw[k]);
+                }
+                parsed.push_back(make_figure<T>(type, c));
+            });
+    } else {
+        loaded = common::parse_figures_text<T>(file.data(), file.data() + file.size(), vertices_for_type,
+            [&](int type, const T* c, size_t) { parsed.push_back(make_figure<T>(type, c)); });
+    }
+    for (auto& figure : parsed) {
+        out.push_back(std::move(figure));
+    }
+    return loaded;
+}
+
+template <ScalarType T>
+void save_figures_binary(const std::string& path, const Array<std::shared_ptr<Figure<T>>>& figures) {
+    std::vector<unsigned char> types;
+    std::vector<double> coords;
+    types.reserve(figures.get_size());
+    for (size_t i = 0; i < figures.get_size(); ++i) {
+        const Figure<T>* fig = figures[i].get();
+        unsigned char type = 0;
+        if (dynamic_cast<const Trapezoid<T>*>(fig)) type = 1;
+        else if (dynamic_cast<const Rhombus<T>*>(fig)) type = 2;
+        else if (dynamic_cast<const Pentagon<T>*>(fig)) type = 3;
+        else throw std::runtime_error("Тип фигуры нельзя сохранить в бинарном формате");
+        types.push_back(type);
+        for (const auto& p : fig->points()) {
+            coords.push_back(static_cast<double>(p.x));
+            coords.push_back(static_cast<double>(p.y));
+        }
+    }
+    common::write_figures_binary(path, kBinaryMagic, types, coords);
+}
+
 template class Figure<double>;
 template class Trapezoid<double>;
 template class Rhombus<double>;
@@ -181,4 +428,31 @@ template class Array<std::shared_ptr<Trapezoid<double>>>;
 template class Array<std::shared_ptr<Rhombus<double>>>;
 template class Array<std::shared_ptr<Rhombus<int>>>;
 template class Array<std::shared_ptr<Rhombus<float>>>;
-template class Array<std::shared_ptr<Trapezoid<float>>>;
\ No newline at end of file
+template class Array<std::shared_ptr<Trapezoid<float>>>;
+template class Array<FigureVariant<double>>;
+template class Array<FigureVariant<int>>;
+template class Array<FigureVariant<float>>;
+template class SlotMap<std::shared_ptr<Figure<double>>>;
+template class SlotMap<std::shared_ptr<Figure<int>>>;
+template class SlotMap<std::shared_ptr<Figure<float>>>;
+template FigureStats compute_stats<double>(const Array<std::shared_ptr<Figure<double>>>&, unsigned);
+template FigureStats compute_stats<int>(const Array<std::shared_ptr<Figure<int>>>&, unsigned);
+template FigureStats compute_stats<float>(const Array<std::shared_ptr<Figure<float>>>&, unsigned);
+template size_t load_figures<double>(const std::string&, Array<std::shared_ptr<Figure<double>>>&);
+template size_t load_figures<int>(const std::string&, Array<std::shared_ptr<Figure<int>>>&);
+template size_t load_figures<float>(const std::string&, Array<std::shared_ptr<Figure<float>>>&);
+template void save_figures_binary<double>(const std::string&, const Array<std::shared_ptr<Figure<double>>>&);
+template void save_figures_binary<int>(const std::string&, const Array<std::shared_ptr<Figure<int>>>&);
+template void save_figures_binary<float>(const std::string&, const Array<std::shared_ptr<Figure<float>>>&);
+template double total_area<double>(const FigureVariantArray<double>&);
+template double total_area<int>(const FigureVariantArray<int>&);
+template double total_area<float>(const FigureVariantArray<float>&);
+template double total_area<double>(const Array<std::shared_ptr<Figure<double>>>&);
+template double total_area<int>(const Array<std::shared_ptr<Figure<int>>>&);
+template double total_area<float>(const Array<std::shared_ptr<Figure<float>>>&);
+template void print_all<double>(const FigureVariantArray<double>&);
+template void print_all<int>(const FigureVariantArray<int>&);
+template void print_all<float>(const FigureVariantArray<float>&);
+template void print_all<double>(const Array<std::shared_ptr<Figure<double>>>&);
+template void print_all<int>(const Array<std::shared_ptr<Figure<int>>>&);
+template void print_all<float>(const Array<std::shared_ptr<Figure<float>>>&);
@@ -8,6 +8,13 @@
 #include <numeric>
 #include <algorithm>
 #include <type_traits> 
+#include <array>
+#include <span>
+#include <string>
+#include <cstdint>
+#include <utility>
+#include <variant>
+#include <atomic>
 
 template <typename T>
 concept ScalarType = std::is_scalar_v<T>;
@@ -16,7 +23,7 @@ template <ScalarType T>
 class Point {
 public:
     T x, y;
-    Point(T _x = T{}, T _y = T{}) : x(_x), y(_y) {}
+    constexpr Point(T _x = T{}, T _y = T{}) : x(_x), y(_y) {}
     Point(const Point&) = default;
     Point& operator=(const Point&) = default;
     Point(Point&&) noexcept = default;
@@ -26,11 +33,10 @@ public:
 template <ScalarType T>
 class Figure {
 public:
-    using PointPtr = std::unique_ptr<Point<T>>;
     using FigurePtr = std::unique_ptr<Figure<T>>;
     
     Figure() = default;
-    Figure(const Figure& other); 
+    Figure(const Figure& other) = default; 
     Figure& operator=(const Figure& other) = delete; 
     Figure(Figure&&) noexcept = default;
     Figure& operator=(Figure&&) noexcept = default;
@@ -44,41 +50,209 @@ public:
 
     virtual FigurePtr clone() const = 0;
 
+    // Вершины фигуры лежат подряд в памяти наследника.
+    virtual std::span<const Point<T>> points() const = 0;
+
     virtual ~Figure() = default;
 
 protected:
-    std::vector<PointPtr> vertices;
+    // Кэш площади и центра заполняет наследник при конструировании.
+    double cached_area = 0.0;
+    Point<T> cached_center;
+};
+
+// Площадь по формуле шнуровки для известного на этапе компиляции числа вершин:
+// цикл полностью развёрнут, индекс следующей вершины — константа.
+template <ScalarType T, size_t N>
+constexpr double polygon_area(const std::array<Point<T>, N>& v) {
+    if constexpr (N < 3) {
+        return 0.0;
+    } else {
+        double twice = [&]<size_t... I>(std::index_sequence<I...>) {
+            return (0.0 + ... + (static_cast<double>(v[I].x) * static_cast<double>(v[(I + 1) % N].y) -
+                                 static_cast<double>(v[(I + 1) % N].x) * static_cast<double>(v[I].y)));
+        }(std::make_index_sequence<N>{});
+        return (twice < 0 ? -twice : twice) / 2.0;
+    }
+}
+
+template <ScalarType T, size_t N>
+constexpr Point<T> polygon_center(const std::array<Point<T>, N>& v) {
+    if constexpr (N == 0) {
+        return Point<T>{};
+    } else {
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            T sum_x = (T{} + ... + v[I].x);
+            T sum_y = (T{} + ... + v[I].y);
+            return Point<T>{static_cast<T>(sum_x / static_cast<T>(N)), static_cast<T>(sum_y / static_cast<T>(N))};
+        }(std::make_index_sequence<N>{});
+    }
+}
+
+template <ScalarType T, size_t N>
+class PolygonFigure : public Figure<T> {
+public:
+    static constexpr size_t vertex_count = N;
+
+    explicit PolygonFigure(const std::array<Point<T>, N>& pts) : vertices(pts) {
+        this->cached_area = polygon_area(vertices);
+        this->cached_center = polygon_center(vertices);
+    }
+    PolygonFigure(const PolygonFigure&) = default;
+    PolygonFigure(PolygonFigure&&) noexcept = default;
+    PolygonFigure& operator=(PolygonFigure&&) noexcept = default;
+
+    std::span<const Point<T>> points() const override { return vertices; }
+
+protected:
+    std::array<Point<T>, N> vertices;
 };
 
 
 template <class T>
 class Array {
 private:
-    std::shared_ptr<T[]> data; 
-    size_t capacity = 0;
+    // Неинициализированный буфер: сконструированы только первые size элементов.
+    T* items = nullptr;
     size_t size = 0;
-    void resize(size_t new_capacity);
+    size_t capacity = 0;
+    double growth_factor = 2.0;
+
+    void reallocate(size_t new_capacity);
+    void release();
+    size_t next_capacity(size_t min_capacity) const;
 
 public:
     Array() = default;
-    Array(const Array&) = default;
-    Array& operator=(const Array&) = default;
-    Array(Array&&) noexcept = default;
-    Array& operator=(Array&&) noexcept = default;
+    // Копия глубокая: буфером всегда владеет один массив. Для общего буфера есть CowArray.
+    Array(const Array& other);
+    Array& operator=(const Array& other);
+    Array(Array&& other) noexcept;
+    Array& operator=(Array&& other) noexcept;
+    ~Array() { release(); }
 
     void push_back(T item);
+    template <class... Args>
+    T& emplace_back(Args&&... args);
+    void reserve(size_t new_capacity);
+    void set_growth_factor(double factor);
     void remove_at(size_t index); 
+    // Удаление за O(1): последний элемент переносится на место удалённого.
+    void swap_remove_at(size_t index);
     T& operator[](size_t index);
     const T& operator[](size_t index) const;
     size_t get_size() const { return size; }
+    size_t get_capacity() const { return capacity; }
+};
+
+template <class T>
+template <class... Args>
+T& Array<T>::emplace_back(Args&&... args) {
+    if (size == capacity) {
+        // Новый элемент строится до переноса старых: args могут ссылаться на них.
+        size_t new_capacity = next_capacity(size + 1);
+        T* fresh = std::allocator<T>().allocate(new_capacity);
+        try {
+            std::construct_at(fresh + size, std::forward<Args>(args)...);
+        } catch (...) {
+            std::allocator<T>().deallocate(fresh, new_capacity);
+            throw;
+        }
+        std::uninitialized_move_n(items, size, fresh);
+        size_t n = size;
+        release();
+        items = fresh;
+        size = n;
+        capacity = new_capacity;
+    } else {
+        std::construct_at(items + size, std::forward<Args>(args)...);
+    }
+    return items[size++];
+}
+
+// Явно разделяемый массив с копированием при записи: копии дескриптора делят
+// один буфер, а write() отделяет собственную копию, если буфер ещё кем-то используется.
+// Сам дескриптор не потокобезопасен: каждому потоку нужна своя копия.
+template <class T>
+class CowArray {
+public:
+    CowArray() : data(std::make_shared<Array<T>>()) {}
+    explicit CowArray(Array<T> array) : data(std::make_shared<Array<T>>(std::move(array))) {}
+
+    const Array<T>& read() const { return *data; }
+    Array<T>& write() {
+        if (data.use_count() > 1) {
+            data = std::make_shared<Array<T>>(*data);
+        } else {
+            // Видим единственного владельца — подтягиваем чтения, сделанные
+            // другими дескрипторами до их уничтожения.
+            std::atomic_thread_fence(std::memory_order_acquire);
+        }
+        return *data;
+    }
+    bool is_shared() const { return data.use_count() > 1; }
+
+private:
+    std::shared_ptr<Array<T>> data;
 };
 
+// Контейнер со стабильными дескрипторами: элементы лежат плотно, удаление за O(1),
+// а устаревший дескриптор распознаётся по поколению слота.
+template <class T>
+class SlotMap {
+public:
+    struct Handle {
+        uint32_t index = UINT32_MAX;
+        uint32_t generation = 0;
+        bool operator==(const Handle&) const = default;
+    };
+
+    Handle insert(T item);
+    bool erase(Handle handle);
+    bool contains(Handle handle) const;
+    T* get(Handle handle);
+    const T* get(Handle handle) const;
+
+    // Плотный доступ для обхода всех элементов.
+    T& operator[](size_t index);
+    const T& operator[](size_t index) const;
+    size_t get_size() const { return values.size(); }
+
+private:
+    struct Slot {
+        uint32_t target = 0;      // плотный индекс или следующий свободный слот
+        uint32_t generation = 0;
+        bool alive = false;
+    };
+
+    std::vector<Slot> slots;
+    std::vector<T> values;
+    std::vector<uint32_t> owners;  // плотный индекс -> слот
+    uint32_t free_head = UINT32_MAX;
+};
 
+struct FigureStats {
+    size_t count = 0;
+    double total_area = 0.0;
+    double min_area = 0.0;
+    double max_area = 0.0;
+    Point<double> bbox_min, bbox_max;
+    Point<double> mean_center;
+};
+
+// Параллельные агрегаты по массиву фигур с компенсированным суммированием.
+// threads == 0: число потоков выбирается по размеру массива и числу ядер.
 template <ScalarType T>
-class Trapezoid : public Figure<T> {
+FigureStats compute_stats(const Array<std::shared_ptr<Figure<T>>>& figures, unsigned threads = 0);
+
+
+template <ScalarType T>
+class Trapezoid final : public PolygonFigure<T, 4> {
 public:
     Trapezoid(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4);
-    Trapezoid(const Trapezoid& other) : Figure<T>(other) {}
+    Trapezoid(const Trapezoid& other) = default;
+    Trapezoid(Trapezoid&&) noexcept = default;
+    Trapezoid& operator=(Trapezoid&&) noexcept = default;
 
     Point<T> center() const override; 
     void print_coords() const override;
@@ -91,10 +265,12 @@ public:
 };
 
 template <ScalarType T>
-class Rhombus : public Figure<T> {
+class Rhombus final : public PolygonFigure<T, 4> {
 public:
     Rhombus(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4); 
-    Rhombus(const Rhombus& other) : Figure<T>(other) {}
+    Rhombus(const Rhombus& other) = default;
+    Rhombus(Rhombus&&) noexcept = default;
+    Rhombus& operator=(Rhombus&&) noexcept = default;
 
     Point<T> center() const override; 
     void print_coords() const override;
@@ -107,10 +283,12 @@ public:
 };
 
 template <ScalarType T>
-class Pentagon : public Figure<T> {
+class Pentagon final : public PolygonFigure<T, 5> {
 public:
     Pentagon(T x1, T y1, T x2, T y2, T x3, T y3, T x4, T y4, T x5, T y5);
-    Pentagon(const Pentagon& other) : Figure<T>(other) {}
+    Pentagon(const Pentagon& other) = default;
+    Pentagon(Pentagon&&) noexcept = default;
+    Pentagon& operator=(Pentagon&&) noexcept = default;
 
     Point<T> center() const override; 
     void print_coords() const override;
@@ -122,4 +300,32 @@ public:
     }
 };
 
+// Закрытый набор фигур, хранимых по значению: тип известен из variant,
+// поэтому вызовы через std::visit не идут через таблицу виртуальных функций.
+template <ScalarType T>
+using FigureVariant = std::variant<Trapezoid<T>, Rhombus<T>, Pentagon<T>>;
+
+template <ScalarType T>
+using FigureVariantArray = Array<FigureVariant<T>>;
+
+template <ScalarType T>
+double total_area(const FigureVariantArray<T>& figures);
+template <ScalarType T>
+double total_area(const Array<std::shared_ptr<Figure<T>>>& figures);
+template <ScalarType T>
+void print_all(const FigureVariantArray<T>& figures);
+template <ScalarType T>
+void print_all(const Array<std::shared_ptr<Figure<T>>>& figures);
+
+// Пакетная загрузка фигур из файла без интерактивного ввода; формат определяется по сигнатуре.
+// Текстовый: одна фигура на строку, "<тип> x1 y1 x2 y2 ...", тип как в меню
+// (1: Trapezoid, 2: Rhombus, 3: Pentagon), разделители — пробелы или запятые, '#' — комментарий.
+// Бинарный: "FIG4", 4 резервных байта, число фигур (uint64), типы (uint8 на фигуру),
+// выравнивание до 8 байт и упакованные координаты double.
+// При ошибке формата бросает std::runtime_error. Возвращает число загруженных фигур.
+template <ScalarType T>
+size_t load_figures(const std::string& path, Array<std::shared_ptr<Figure<T>>>& out);
+template <ScalarType T>
+void save_figures_binary(const std::string& path, const Array<std::shared_ptr<Figure<T>>>& figures);
+
 #endif 
\ No newline at end of file
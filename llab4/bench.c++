@@ -0,0 +1,83 @@
+#include "Geometry.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <streambuf>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Поток-приёмник: вывод форматируется, но никуда не пишется.
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize n) override { return n; }
+};
+
+template <class F>
+double time_ns_per_op(size_t ops, F&& body) {
+    auto t0 = Clock::now();
+    body();
+    auto t1 = Clock::now();
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / ops;
+}
+
+void fill(size_t n, FigureVariantArray<double>& values, Array<std::shared_ptr<Figure<double>>>& pointers) {
+    values.reserve(n);
+    pointers.reserve(n);
+    for (size_t i = 0; i < n; ++i) {
+        double d = static_cast<double>(i % 1000);
+        switch (i % 3) {
+        case 0:
+            values.emplace_back(std::in_place_type<Trapezoid<double>>, d, 0.0, d + 5, 0.0, d + 4, 3.0, d + 1, 3.0);
+            pointers.push_back(std::make_shared<Trapezoid<double>>(d, 0.0, d + 5, 0.0, d + 4, 3.0, d + 1, 3.0));
+            break;
+        case 1:
+            values.emplace_back(std::in_place_type<Rhombus<double>>, d + 1, 0.0, d, 1.0, d - 1, 0.0, d, -1.0);
+            pointers.push_back(std::make_shared<Rhombus<double>>(d + 1, 0.0, d, 1.0, d - 1, 0.0, d, -1.0));
+            break;
+        default:
+            values.emplace_back(std::in_place_type<Pentagon<double>>,
+                                d, 1.0, d + 0.95, 0.31, d + 0.59, -0.81, d - 0.59, -0.81, d - 0.95, 0.31);
+            pointers.push_back(std::make_shared<Pentagon<double>>(
+                d, 1.0, d + 0.95, 0.31, d + 0.59, -0.81, d - 0.59, -0.81, d - 0.95, 0.31));
+            break;
+        }
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t scale = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+    if (scale == 0) scale = 1;
+    const size_t n = 300000 * scale;
+    const size_t rounds = 20;
+
+    FigureVariantArray<double> values;
+    Array<std::shared_ptr<Figure<double>>> pointers;
+    fill(n, values, pointers);
+
+    volatile double sink = 0.0;
+    double variant_area = time_ns_per_op(n * rounds, [&] {
+        for (size_t r = 0; r < rounds; ++r) sink = sink + total_area(values);
+    });
+    double pointer_area = time_ns_per_op(n * rounds, [&] {
+        for (size_t r = 0; r < rounds; ++r) sink = sink + total_area(pointers);
+    });
+
+    NullBuffer null_buffer;
+    std::streambuf* saved = std::cout.rdbuf(&null_buffer);
+    double variant_print = time_ns_per_op(n, [&] { print_all(values); });
+    double pointer_print = time_ns_per_op(n, [&] { print_all(pointers); });
+    std::cout.rdbuf(saved);
+
+    std::printf("%-14s %-10s %10s\n", "workload", "container", "ns/figure");
+    std::printf("%-14s %-10s %10.2f\n", "total_area", "variant", variant_area);
+    std::printf("%-14s %-10s %10.2f\n", "total_area", "pointer", pointer_area);
+    std::printf("%-14s %-10s %10.2f\n", "print", "variant", variant_print);
+    std::printf("%-14s %-10s %10.2f\n", "print", "pointer", pointer_print);
+    return 0;
+}
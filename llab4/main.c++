@@ -35,17 +35,28 @@ std::unique_ptr<Figure<T>> create_figure_from_input() {
     }
 }
 
-int main() {
+int main(int argc, char** argv) {
     using CoordType = double; 
     Array<std::shared_ptr<Figure<CoordType>>> figure_array; 
-    cout << "\n--- Interactive Figure Input ---" << endl;
-    while (true) {
-        cout << "\nEnter figure: ";
-        if (auto fig_uptr = create_figure_from_input<CoordType>()) {
-            figure_array.push_back(std::shared_ptr<Figure<CoordType>>(fig_uptr.release()));
-            cout << "Figure added successfully. Total figures: " << figure_array.get_size() << endl;
-        } else {
-            break;
+    if (argc > 1) {
+        cout << "\n--- Loading figures from " << argv[1] << " ---" << endl;
+        try {
+            size_t loaded = load_figures(argv[1], figure_array);
+            cout << "Loaded " << loaded << " figures." << endl;
+        } catch (const std::exception& e) {
+            cout << "Error loading figures: " << e.what() << endl;
+            return 1;
+        }
+    } else {
+        cout << "\n--- Interactive Figure Input ---" << endl;
+        while (true) {
+            cout << "\nEnter figure: ";
+            if (auto fig_uptr = create_figure_from_input<CoordType>()) {
+                figure_array.push_back(std::shared_ptr<Figure<CoordType>>(fig_uptr.release()));
+                cout << "Figure added successfully. Total figures: " << figure_array.get_size() << endl;
+            } else {
+                break;
+            }
         }
     }
     
@@ -56,7 +67,6 @@ int main() {
         0.0, 1.0, 0.95, 0.31, 0.59, -0.81, -0.59, -0.81, -0.95, 0.31
     ));
 
-    double total_area = 0.0;
     cout << "\n--- Processing all figures in array (" << figure_array.get_size() << " figures) ---" << endl;
     for (size_t i = 0; i < figure_array.get_size(); ++i) {
         auto& fig_ptr = figure_array[i];
@@ -70,15 +80,17 @@ int main() {
         double area_val = static_cast<double>(*fig_ptr);
         cout << "  Area: " << area_val << endl;
         
-        total_area += area_val;
-        
         auto clone_ptr = fig_ptr->clone();
         if (clone_ptr) {
             cout << "  Clone area: " << static_cast<double>(*clone_ptr) << " (verification)" << endl;
         }
     }
 
-    cout << "\nTotal area of all figures: " << total_area << endl;
+    FigureStats stats = compute_stats(figure_array);
+    cout << "\nTotal area of all figures: " << stats.total_area << endl;
+    cout << "Area range: [" << stats.min_area << ", " << stats.max_area << "]" << endl;
+    cout << "Bounding box: (" << stats.bbox_min.x << ", " << stats.bbox_min.y << ") - ("
+         << stats.bbox_max.x << ", " << stats.bbox_max.y << ")" << endl;
 
     if (figure_array.get_size() > 0) {
         size_t index_to_remove = 0; 
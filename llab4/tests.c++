@@ -2,6 +2,8 @@
 #include <gtest/gtest.h>
 #include <cmath>
 #include <typeinfo>
+#include <fstream>
+#include <stdexcept>
 using namespace std;
 
 TEST(PointTest, DefaultConstructor) {
@@ -42,6 +44,122 @@ TEST(ArrayTest, RemoveAt) {
     EXPECT_EQ(arr.get_size(), 1);
     EXPECT_THROW(arr.remove_at(5), std::out_of_range);
 }
+TEST(ArrayTest, SwapRemoveAt) {
+    Array<std::shared_ptr<Figure<double>>> arr;
+    auto a = make_shared<Rhombus<double>>(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0);
+    auto b = make_shared<Trapezoid<double>>(0.0, 0.0, 5.0, 0.0, 4.0, 3.0, 1.0, 3.0);
+    auto c = make_shared<Rhombus<double>>(2.0, 0.0, 0.0, 2.0, -2.0, 0.0, 0.0, -2.0);
+    arr.push_back(a);
+    arr.push_back(b);
+    arr.push_back(c);
+
+    arr.swap_remove_at(0);
+    ASSERT_EQ(arr.get_size(), 2);
+    EXPECT_EQ(arr[0], c);
+    EXPECT_EQ(arr[1], b);
+    EXPECT_EQ(a.use_count(), 1);
+    arr.swap_remove_at(1);
+    EXPECT_EQ(arr.get_size(), 1);
+    EXPECT_EQ(b.use_count(), 1);
+    EXPECT_THROW(arr.swap_remove_at(1), std::out_of_range);
+}
+TEST(ArrayTest, ReserveAndGrowthFactor) {
+    Array<std::shared_ptr<Figure<double>>> arr;
+    arr.reserve(10);
+    EXPECT_EQ(arr.get_capacity(), 10);
+    EXPECT_EQ(arr.get_size(), 0);
+    for (int i = 0; i < 10; ++i) {
+        arr.emplace_back(make_shared<Rhombus<double>>(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0));
+    }
+    EXPECT_EQ(arr.get_capacity(), 10);
+
+    arr.set_growth_factor(1.5);
+    arr.push_back(make_shared<Trapezoid<double>>(0.0, 0.0, 5.0, 0.0, 4.0, 3.0, 1.0, 3.0));
+    EXPECT_EQ(arr.get_capacity(), 15);
+    EXPECT_EQ(arr.get_size(), 11);
+    EXPECT_NEAR(arr[10]->area(), 12.0, 1e-9);
+    EXPECT_THROW(arr.set_growth_factor(1.0), std::invalid_argument);
+}
+TEST(ArrayTest, DeepCopy) {
+    Array<std::shared_ptr<Figure<double>>> a;
+    auto rhombus = make_shared<Rhombus<double>>(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0);
+    a.push_back(rhombus);
+    a.push_back(make_shared<Trapezoid<double>>(0.0, 0.0, 5.0, 0.0, 4.0, 3.0, 1.0, 3.0));
+
+    std::shared_ptr<Figure<double>>& first = a[0];
+    Array<std::shared_ptr<Figure<double>>> b = a;
+    EXPECT_EQ(rhombus.use_count(), 3);
+    EXPECT_NE(&b[0], &first);
+
+    b.remove_at(0);
+    EXPECT_EQ(a.get_size(), 2);
+    EXPECT_EQ(b.get_size(), 1);
+    EXPECT_EQ(first, rhombus);
+    EXPECT_NEAR(b[0]->area(), 12.0, 1e-9);
+
+    b = a;
+    EXPECT_EQ(b.get_size(), 2);
+    Array<std::shared_ptr<Figure<double>>> c = std::move(b);
+    EXPECT_EQ(b.get_size(), 0);
+    EXPECT_EQ(c[0], rhombus);
+}
+TEST(ArrayTest, EmplaceFromOwnElement) {
+    Array<std::shared_ptr<Figure<double>>> a;
+    a.push_back(make_shared<Rhombus<double>>(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0));
+    ASSERT_EQ(a.get_size(), a.get_capacity());
+    a.emplace_back(a[0]);
+    EXPECT_EQ(a.get_size(), 2);
+    EXPECT_EQ(a[1], a[0]);
+}
+TEST(CowArrayTest, SharesUntilWrite) {
+    Array<std::shared_ptr<Figure<double>>> source;
+    auto rhombus = make_shared<Rhombus<double>>(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0);
+    source.push_back(rhombus);
+    CowArray<std::shared_ptr<Figure<double>>> a(std::move(source));
+
+    CowArray<std::shared_ptr<Figure<double>>> b = a;
+    EXPECT_TRUE(a.is_shared());
+    EXPECT_EQ(&a.read(), &b.read());
+    EXPECT_EQ(rhombus.use_count(), 2);
+
+    b.write().push_back(make_shared<Trapezoid<double>>(0.0, 0.0, 5.0, 0.0, 4.0, 3.0, 1.0, 3.0));
+    EXPECT_FALSE(a.is_shared());
+    EXPECT_EQ(a.read().get_size(), 1);
+    EXPECT_EQ(b.read().get_size(), 2);
+    EXPECT_EQ(rhombus.use_count(), 3);
+
+    const Array<std::shared_ptr<Figure<double>>>* before = &a.read();
+    a.write().remove_at(0);
+    EXPECT_EQ(&a.read(), before);
+    EXPECT_EQ(b.read()[0], rhombus);
+}
+TEST(SlotMapTest, StableHandles) {
+    SlotMap<std::shared_ptr<Figure<double>>> figures;
+    auto h1 = figures.insert(make_shared<Rhombus<double>>(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0));
+    auto h2 = figures.insert(make_shared<Trapezoid<double>>(0.0, 0.0, 5.0, 0.0, 4.0, 3.0, 1.0, 3.0));
+    auto h3 = figures.insert(make_shared<Rhombus<double>>(2.0, 0.0, 0.0, 2.0, -2.0, 0.0, 0.0, -2.0));
+    EXPECT_EQ(figures.get_size(), 3);
+
+    EXPECT_TRUE(figures.erase(h1));
+    EXPECT_FALSE(figures.erase(h1));
+    EXPECT_FALSE(figures.contains(h1));
+    EXPECT_EQ(figures.get(h1), nullptr);
+    ASSERT_NE(figures.get(h2), nullptr);
+    ASSERT_NE(figures.get(h3), nullptr);
+    EXPECT_NEAR((*figures.get(h2))->area(), 12.0, 1e-9);
+    EXPECT_NEAR((*figures.get(h3))->area(), 8.0, 1e-9);
+
+    auto h4 = figures.insert(make_shared<Trapezoid<double>>(0.0, 0.0, 5.0, 0.0, 4.0, 3.0, 1.0, 3.0));
+    EXPECT_EQ(h4.index, h1.index);
+    EXPECT_NE(h4.generation, h1.generation);
+    EXPECT_EQ(figures.get(h1), nullptr);
+    EXPECT_NE(figures.get(h4), nullptr);
+
+    double total = 0.0;
+    for (size_t i = 0; i < figures.get_size(); ++i) total += figures[i]->area();
+    EXPECT_NEAR(total, 32.0, 1e-9);
+    EXPECT_THROW(figures[3], std::out_of_range);
+}
 TEST(RhombusTest, AreaCalculation) {
     Rhombus<double> rhombus(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0);
     EXPECT_NEAR(rhombus.area(), 2.0, 1e-6);
@@ -102,6 +220,177 @@ TEST(TotalAreaTest, MultipleFigures) {
     }
     EXPECT_NEAR(total_area, 14.0, 1e-6);
 }
+TEST(StorageTest, VerticesAreInline) {
+    Pentagon<double> pentagon(0.0, 1.0, 0.95, 0.31, 0.59, -0.81, -0.59, -0.81, -0.95, 0.31);
+    auto pts = pentagon.points();
+    ASSERT_EQ(pts.size(), 5u);
+    EXPECT_GE(reinterpret_cast<const char*>(pts.data()), reinterpret_cast<const char*>(&pentagon));
+    EXPECT_LT(reinterpret_cast<const char*>(pts.data()),
+              reinterpret_cast<const char*>(&pentagon) + sizeof(pentagon));
+    EXPECT_DOUBLE_EQ(pts[4].x, -0.95);
+
+    Trapezoid<int> trapezoid(0, 0, 5, 0, 4, 3, 1, 3);
+    Trapezoid<int> copy(trapezoid);
+    EXPECT_NE(copy.points().data(), trapezoid.points().data());
+    EXPECT_EQ(copy.points()[2].x, 4);
+    EXPECT_NEAR(copy.area(), 12.0, 1e-6);
+}
+TEST(CacheTest, CopiesKeepCachedValues) {
+    Trapezoid<double> trapezoid(0.0, 0.0, 5.0, 0.0, 4.0, 3.0, 1.0, 3.0);
+    auto clone = trapezoid.clone();
+    Trapezoid<double> copy(trapezoid);
+    EXPECT_DOUBLE_EQ(static_cast<double>(*clone), 12.0);
+    EXPECT_DOUBLE_EQ(copy.area(), 12.0);
+    EXPECT_DOUBLE_EQ(copy.center().x, 2.5);
+    EXPECT_TRUE(trapezoid == *clone);
+
+    Rhombus<int> rhombus(1, 0, 0, 1, -1, 0, 0, -1);
+    EXPECT_DOUBLE_EQ(rhombus.area(), 2.0);
+    EXPECT_EQ(rhombus.center().x, 0);
+}
+TEST(TotalAreaTest, ParallelStats) {
+    Array<std::shared_ptr<Figure<double>>> arr;
+    for (int i = 0; i < 500; ++i) {
+        double d = i;
+        arr.push_back(make_shared<Rhombus<double>>(1.0 + d, 0.0, d, 1.0, -1.0 + d, 0.0, d, -1.0));
+        arr.push_back(make_shared<Trapezoid<double>>(0.0, 0.0, 5.0, 0.0, 4.0, 3.0, 1.0, 3.0));
+    }
+    FigureStats one = compute_stats(arr, 1);
+    FigureStats four = compute_stats(arr, 4);
+    EXPECT_EQ(four.count, 1000);
+    EXPECT_NEAR(one.total_area, 500 * 14.0, 1e-9);
+    EXPECT_NEAR(four.total_area, one.total_area, 1e-9);
+    EXPECT_NEAR(four.min_area, 2.0, 1e-9);
+    EXPECT_NEAR(four.max_area, 12.0, 1e-9);
+    EXPECT_NEAR(four.bbox_min.x, -1.0, 1e-9);
+    EXPECT_NEAR(four.bbox_max.x, 500.0, 1e-9);
+    EXPECT_NEAR(four.bbox_max.y, 3.0, 1e-9);
+    EXPECT_NEAR(four.mean_center.x, one.mean_center.x, 1e-9);
+
+    Array<std::shared_ptr<Figure<int>>> empty;
+    EXPECT_EQ(compute_stats(empty).count, 0);
+}
+TEST(TotalAreaTest, StatsBoxIgnoresFiguresWithoutPoints) {
+    struct EmptyFigure : Figure<double> {
+        void print_coords() const override {}
+        double area() const override { return 0.0; }
+        bool operator==(const Figure<double>&) const override { return false; }
+        FigurePtr clone() const override { return std::make_unique<EmptyFigure>(); }
+        std::span<const Point<double>> points() const override { return {}; }
+    };
+    Array<std::shared_ptr<Figure<double>>> arr;
+    arr.push_back(make_shared<EmptyFigure>());
+    arr.push_back(make_shared<Rhombus<double>>(12.0, 5.0, 11.0, 6.0, 10.0, 5.0, 11.0, 4.0));
+    FigureStats stats = compute_stats(arr, 1);
+    EXPECT_EQ(stats.count, 2);
+    EXPECT_NEAR(stats.bbox_min.x, 10.0, 1e-9);
+    EXPECT_NEAR(stats.bbox_min.y, 4.0, 1e-9);
+    EXPECT_NEAR(stats.bbox_max.x, 12.0, 1e-9);
+}
+TEST(LoaderTest, TextFormat) {
+    string path = testing::TempDir() + "geometry.txt";
+    {
+        ofstream out(path);
+        out << "# type x1 y1 ...\n"
+            << "1, 0, 0, 5, 0, 4, 3, 1, 3\n"
+            << "2 1 0 0 1 -1 0 0 -1  # rhombus\n"
+            << "\n"
+            << "3 0 1 0.95 0.31 0.59 -0.81 -0.59 -0.81 -0.95 0.31";
+    }
+    Array<std::shared_ptr<Figure<double>>> arr;
+    EXPECT_EQ(load_figures(path, arr), 3);
+    ASSERT_EQ(arr.get_size(), 3);
+    EXPECT_NE(dynamic_cast<Trapezoid<double>*>(arr[0].get()), nullptr);
+    EXPECT_NE(dynamic_cast<Rhombus<double>*>(arr[1].get()), nullptr);
+    EXPECT_NE(dynamic_cast<Pentagon<double>*>(arr[2].get()), nullptr);
+    EXPECT_NEAR(arr[0]->area(), 12.0, 1e-9);
+    EXPECT_NEAR(arr[1]->area(), 2.0, 1e-9);
+
+    Array<std::shared_ptr<Figure<int>>> ints;
+    EXPECT_THROW(load_figures(path, ints), std::runtime_error);
+    EXPECT_EQ(ints.get_size(), 0);
+
+    {
+        ofstream out(path);
+        out << "2 1 0 0 1 -1 0 0\n";
+    }
+    Array<std::shared_ptr<Figure<double>>> broken;
+    EXPECT_THROW(load_figures(path, broken), std::runtime_error);
+}
+TEST(LoaderTest, BinaryRoundTrip) {
+    Array<std::shared_ptr<Figure<float>>> arr;
+    for (int i = 0; i < 20; ++i) {
+        float d = static_cast<float>(i);
+        arr.push_back(make_shared<Trapezoid<float>>(d, 0, d + 5, 0, d + 4, 3, d + 1, 3));
+        arr.push_back(make_shared<Pentagon<float>>(0, 1, 0.95f, 0.31f, 0.59f, -0.81f, -0.59f, -0.81f, -0.95f, 0.31f));
+    }
+    string path = testing::TempDir() + "geometry.bin";
+    save_figures_binary(path, arr);
+
+    Array<std::shared_ptr<Figure<float>>> loaded;
+    EXPECT_EQ(load_figures(path, loaded), arr.get_size());
+    ASSERT_EQ(loaded.get_size(), arr.get_size());
+    for (size_t i = 0; i < arr.get_size(); ++i) {
+        EXPECT_DOUBLE_EQ(loaded[i]->area(), arr[i]->area());
+        EXPECT_FLOAT_EQ(loaded[i]->center().x, arr[i]->center().x);
+    }
+    EXPECT_NE(dynamic_cast<Pentagon<float>*>(loaded[1].get()), nullptr);
+
+    Array<std::shared_ptr<Figure<double>>> wide;
+    wide.push_back(make_shared<Rhombus<double>>(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0));
+    save_figures_binary(path, wide);
+    Array<std::shared_ptr<Figure<int>>> ints;
+    EXPECT_EQ(load_figures(path, ints), 1);
+    wide.push_back(make_shared<Rhombus<double>>(1e12, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0));
+    save_figures_binary(path, wide);
+    Array<std::shared_ptr<Figure<int>>> overflow;
+    EXPECT_THROW(load_figures(path, overflow), std::runtime_error);
+    EXPECT_EQ(overflow.get_size(), 0);
+}
+TEST(KernelTest, CompileTimeArea) {
+    constexpr std::array<Point<double>, 4> trapezoid{{{0.0, 0.0}, {5.0, 0.0}, {4.0, 3.0}, {1.0, 3.0}}};
+    static_assert(polygon_area(trapezoid) == 12.0);
+    static_assert(polygon_center(trapezoid).x == 2.5);
+    static_assert(polygon_center(trapezoid).y == 1.5);
+
+    constexpr std::array<Point<int>, 4> rhombus{{{1, 0}, {0, 1}, {-1, 0}, {0, -1}}};
+    static_assert(polygon_area(rhombus) == 2.0);
+
+    constexpr std::array<Point<int>, 2> segment{{{0, 0}, {1, 1}}};
+    static_assert(polygon_area(segment) == 0.0);
+
+    Pentagon<double> pentagon(0.0, 1.0, 0.95, 0.31, 0.59, -0.81, -0.59, -0.81, -0.95, 0.31);
+    std::array<Point<double>, 5> pts;
+    std::copy(pentagon.points().begin(), pentagon.points().end(), pts.begin());
+    EXPECT_DOUBLE_EQ(pentagon.area(), polygon_area(pts));
+    EXPECT_NEAR(pentagon.area(), 2.377, 0.01);
+    Trapezoid<float> ft(0, 0, 5, 0, 4, 3, 1, 3);
+    EXPECT_DOUBLE_EQ(ft.area(), 12.0);
+}
+TEST(VariantTest, MatchesPointerContainer) {
+    FigureVariantArray<double> values;
+    Array<std::shared_ptr<Figure<double>>> pointers;
+    for (int i = 0; i < 10; ++i) {
+        double d = i;
+        values.emplace_back(Trapezoid<double>(d, 0.0, d + 5.0, 0.0, d + 4.0, 3.0, d + 1.0, 3.0));
+        values.emplace_back(std::in_place_type<Rhombus<double>>, 1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0);
+        pointers.push_back(make_shared<Trapezoid<double>>(d, 0.0, d + 5.0, 0.0, d + 4.0, 3.0, d + 1.0, 3.0));
+        pointers.push_back(make_shared<Rhombus<double>>(1.0, 0.0, 0.0, 1.0, -1.0, 0.0, 0.0, -1.0));
+    }
+    EXPECT_NEAR(total_area(values), 10 * 14.0, 1e-9);
+    EXPECT_DOUBLE_EQ(total_area(values), total_area(pointers));
+    EXPECT_TRUE(std::holds_alternative<Rhombus<double>>(values[1]));
+
+    values.swap_remove_at(0);
+    EXPECT_EQ(values.get_size(), 19);
+    EXPECT_NEAR(total_area(values), 10 * 14.0 - 12.0, 1e-9);
+
+    testing::internal::CaptureStdout();
+    print_all(values);
+    string output = testing::internal::GetCapturedStdout();
+    EXPECT_NE(output.find("Rhombus coordinates"), string::npos);
+    EXPECT_NE(output.find("Trapezoid coordinates"), string::npos);
+}
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -0,0 +1,203 @@
+#include "func.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#if defined(__unix__)
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Обёртка над ресурсом, замеряющая время каждого выделения.
+// try_expand пробрасывается в upstream, чтобы контейнер мог расти на месте.
+class LatencyRecordingResource : public std::pmr::memory_resource, public InPlaceExpandable {
+    std::pmr::memory_resource* upstream_;
+    InPlaceExpandable* expander_;
+    std::vector<uint64_t> samples_;
+    size_t expanded_ = 0;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override {
+        auto t0 = Clock::now();
+        void* p = upstream_->allocate(bytes, alignment);
+        auto t1 = Clock::now();
+        samples_.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        return p;
+    }
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override {
+        upstream_->deallocate(p, bytes, alignment);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+
+public:
+    LatencyRecordingResource(std::pmr::memory_resource* upstream, InPlaceExpandable* expander)
+        : upstream_(upstream), expander_(expander) {
+        samples_.reserve(1 << 20);
+    }
+
+    bool try_expand(void* p, size_t old_bytes, size_t new_bytes) override {
+        if (!expander_ || !expander_->try_expand(p, old_bytes, new_bytes)) return false;
+        ++expanded_;
+        return true;
+    }
+
+    uint64_t percentile(double q) {
+        if (samples_.empty()) return 0;
+        size_t k = static_cast<size_t>(q * (samples_.size() - 1));
+        std::nth_element(samples_.begin(), samples_.begin() + k, samples_.end());
+        return samples_[k];
+    }
+    size_t count() const { return samples_.size(); }
+    size_t expanded() const { return expanded_; }
+};
+
+struct Workload {
+    const char* name;
+    size_t ops;
+    std::function<void(LatencyRecordingResource*, size_t)> run;
+};
+
+// make() возвращает nullptr для глобального new_delete_resource().
+// expander() отдаёт интерфейс роста на месте, если ресурс его поддерживает.
+struct Backend {
+    const char* name;
+    std::function<std::unique_ptr<std::pmr::memory_resource>()> make;
+    std::function<InPlaceExpandable*(std::pmr::memory_resource*)> expander;
+};
+
+long peak_rss_kb() {
+#if defined(__unix__)
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_maxrss;
+#else
+    return -1;
+#endif
+}
+
+void run_case(const Backend& backend, const Workload& work) {
+    auto owned = backend.make();
+    LatencyRecordingResource mr(owned ? owned.get() : std::pmr::new_delete_resource(),
+                                backend.expander ? backend.expander(owned.get()) : nullptr);
+
+    auto t0 = Clock::now();
+    work.run(&mr, work.ops);
+    auto t1 = Clock::now();
+
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count();
+    std::printf("%-22s %-16s %10.2f %10zu %10zu %10llu %12ld\n",
+                work.name, backend.name, ns / work.ops, mr.count(), mr.expanded(),
+                static_cast<unsigned long long>(mr.percentile(0.99)), peak_rss_kb());
+    std::fflush(stdout);
+}
+
+// Каждый случай запускается в отдельном процессе, чтобы пиковый RSS не накапливался.
+void run_isolated(const Backend& backend, const Workload& work) {
+#if defined(__unix__)
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        run_case(backend, work);
+        std::_Exit(0);
+    }
+    if (pid > 0) {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        return;
+    }
+#endif
+    run_case(backend, work);
+}
+
+void push_ints(LatencyRecordingResource* mr, size_t n) {
+    DynamicArray<int> arr(mr);
+    for (size_t i = 0; i < n; ++i) arr.push_back(static_cast<int>(i));
+}
+
+void push_clear_rounds(LatencyRecordingResource* mr, size_t n) {
+    const size_t round = 1000;
+    for (size_t done = 0; done < n; done += round) {
+        DynamicArray<int> arr(mr);
+        for (size_t i = 0; i < round; ++i) arr.push_back(static_cast<int>(i));
+        arr.clear();
+    }
+}
+
+// Массив растёт с нуля поверх только что освобождённого крупного блока:
+// ресурс с ростом на месте обходится без перевыделений.
+void regrow_rounds(LatencyRecordingResource* mr, size_t n) {
+    const size_t round = 1000;
+    for (size_t done = 0; done < n; done += round) {
+        {
+            DynamicArray<int> big(mr);
+            big.reserve(round);
+        }
+        DynamicArray<int> arr(mr);
+        for (size_t i = 0; i < round; ++i) arr.push_back(static_cast<int>(i));
+    }
+}
+
+void emplace_points(LatencyRecordingResource* mr, size_t n) {
+    DynamicArray<Point> arr(mr);
+    for (size_t i = 0; i < n; ++i)
+        arr.emplace_back(static_cast<int>(i), -static_cast<int>(i), "point");
+}
+
+void small_arrays_churn(LatencyRecordingResource* mr, size_t n) {
+    std::vector<DynamicArray<int>> live;
+    live.reserve(64);
+    for (size_t i = 0; i < n; ++i) {
+        if (live.size() == 64) live.clear();
+        live.emplace_back(mr);
+        live.back().reserve(1 + i % 32);
+    }
+}
+
+}
+
+int main(int argc, char** argv) {
+    size_t scale = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1;
+    if (scale == 0) scale = 1;
+
+    std::vector<Backend> backends = {
+        {"new_delete", [] { return std::unique_ptr<std::pmr::memory_resource>(); }, nullptr},
+        {"monotonic", [] {
+            return std::unique_ptr<std::pmr::memory_resource>(new std::pmr::monotonic_buffer_resource);
+        }, nullptr},
+        {"unsync_pool", [] {
+            return std::unique_ptr<std::pmr::memory_resource>(new std::pmr::unsynchronized_pool_resource);
+        }, nullptr},
+        {"dynamic_list", [] {
+            return std::unique_ptr<std::pmr::memory_resource>(new DynamicListMemoryResource);
+        }, [](std::pmr::memory_resource* mr) -> InPlaceExpandable* {
+            return static_cast<DynamicListMemoryResource*>(mr);
+        }},
+    };
+
+    std::vector<Workload> workloads = {
+        {"push_back<int>", 1000000 * scale, push_ints},
+        {"push_clear<int>", 1000000 * scale, push_clear_rounds},
+        {"regrow<int>", 1000000 * scale, regrow_rounds},
+        {"emplace_back<Point>", 200000 * scale, emplace_points},
+        {"small_arrays_churn", 20000 * scale, small_arrays_churn},
+    };
+
+    std::printf("%-22s %-16s %10s %10s %10s %10s %12s\n",
+                "workload", "resource", "ns/op", "allocs", "in-place", "p99 ns", "peak RSS KB");
+    for (const auto& work : workloads)
+        for (const auto& backend : backends)
+            run_isolated(backend, work);
+    return 0;
+}
@@ -1,18 +1,102 @@
 #include "func.h"
 #include <new>
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr size_t kBlockAlignment = alignof(std::max_align_t);
+}
+
+void* HugePageMemoryResource::do_allocate(size_t bytes, size_t alignment) {
+#if defined(__linux__)
+    if (bytes >= min_bytes_ && alignment <= kHugePageSize) {
+        size_t length = (bytes + kHugePageSize - 1) & ~(kHugePageSize - 1);
+        // Берём на одну huge-страницу больше, чтобы выровнять начало по 2 МБ.
+        void* raw = mmap(nullptr, length + kHugePageSize, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw != MAP_FAILED) {
+            auto addr = reinterpret_cast<uintptr_t>(raw);
+            auto aligned = (addr + kHugePageSize - 1) & ~(uintptr_t(kHugePageSize) - 1);
+            if (aligned > addr)
+                munmap(raw, aligned - addr);
+            size_t tail = kHugePageSize - (aligned - addr);
+            if (tail > 0)
+                munmap(reinterpret_cast<void*>(aligned + length), tail);
+
+            void* p = reinterpret_cast<void*>(aligned);
+            bool advised = false;
+#if defined(MADV_HUGEPAGE)
+            advised = madvise(p, length, MADV_HUGEPAGE) == 0;
+#endif
+            int bound = -1;  // -1 — привязка не запрашивалась
+#if defined(SYS_mbind)
+            if (numa_node_ >= 0 && numa_node_ < 64) {
+                const int kMpolBind = 2;
+                unsigned long nodemask = 1UL << numa_node_;
+                bound = syscall(SYS_mbind, p, length, kMpolBind, &nodemask, sizeof(nodemask) * 8 + 1, 0) == 0;
+            }
+#endif
+            std::lock_guard<std::mutex> lock(mutex_);
+            mapped_.emplace(p, length);
+            ++stats_.mapped;
+            stats_.huge_advised += advised;
+            if (bound == 1) ++stats_.numa_bound;
+            if (bound == 0) ++stats_.numa_failed;
+            return p;
+        }
+    }
+#endif
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ++stats_.fallback;
+    }
+    return fallback_->allocate(bytes, alignment);
+}
+void HugePageMemoryResource::do_deallocate(void* p, size_t bytes, size_t alignment) {
+#if defined(__linux__)
+    size_t length = 0;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = mapped_.find(p);
+        if (it != mapped_.end()) {
+            length = it->second;
+            mapped_.erase(it);
+        }
+    }
+    if (length > 0) {
+        munmap(p, length);
+        return;
+    }
+#endif
+    fallback_->deallocate(p, bytes, alignment);
+}
+bool HugePageMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+    return this == &other;
+}
+HugePageMemoryResource::~HugePageMemoryResource() {
+#if defined(__linux__)
+    for (auto& m : mapped_) munmap(m.first, m.second);
+#endif
+}
 
 void* DynamicListMemoryResource::do_allocate(size_t bytes, size_t alignment) {
     (void)alignment;
     for (auto it = free_pool_.begin(); it != free_pool_.end(); ++it) {
-        if (it->size >= bytes) {
+        if (it->capacity >= bytes) {
             void* p = it->ptr;
-            allocated_.emplace_back(p, bytes);
+            allocated_.emplace_back(p, bytes, it->capacity);
             free_pool_.erase(it);
             return p;
         }
     }
-    void* p = ::operator new(bytes);
+    void* p = upstream_->allocate(bytes, kBlockAlignment);
     allocated_.emplace_back(p, bytes);
     return p;
 }
@@ -20,27 +104,55 @@ void DynamicListMemoryResource::do_deallocate(void* p, size_t bytes, size_t alig
     (void)alignment;
     for (auto it = allocated_.begin(); it != allocated_.end(); ++it) {
         if (it->ptr == p && it->size == bytes) {
-            free_pool_.emplace_back(p, bytes);
+            free_pool_.emplace_back(p, it->capacity);
             allocated_.erase(it);
             return;
         }
     }
 }
+bool DynamicListMemoryResource::try_expand(void* p, size_t old_bytes, size_t new_bytes) {
+    for (auto& b : allocated_) {
+        if (b.ptr == p && b.size == old_bytes) {
+            if (b.capacity < new_bytes) return false;
+            b.size = new_bytes;
+            return true;
+        }
+    }
+    return false;
+}
 bool DynamicListMemoryResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
     return this == &other;
 }
 DynamicListMemoryResource::~DynamicListMemoryResource() {
-    for (auto& b : allocated_) ::operator delete(b.ptr);
-    for (auto& b : free_pool_) ::operator delete(b.ptr);
+    for (auto& b : allocated_) upstream_->deallocate(b.ptr, b.capacity, kBlockAlignment);
+    for (auto& b : free_pool_) upstream_->deallocate(b.ptr, b.capacity, kBlockAlignment);
+}
+template <typename T>
+void DynamicArray<T>::relocate(T* src, size_t n, T* dst) {
+    if constexpr (std::is_trivially_copyable_v<T>) {
+        if (n > 0)
+            std::memcpy(static_cast<void*>(dst), src, n * sizeof(T));
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            alloc_.construct(&dst[i], std::move_if_noexcept(src[i]));
+            std::destroy_at(&src[i]);
+        }
+    }
+}
+template <typename T>
+bool DynamicArray<T>::try_grow_in_place(size_t new_cap) {
+    if (!data_ || !expander_ ||
+        !expander_->try_expand(data_, capacity_ * sizeof(T), new_cap * sizeof(T)))
+        return false;
+    capacity_ = new_cap;
+    return true;
 }
 template <typename T>
 void DynamicArray<T>::reserve(size_t new_cap) {
     if (new_cap <= capacity_) return;
+    if (try_grow_in_place(new_cap)) return;
     T* new_data = alloc_.allocate(new_cap);
-    for (size_t i = 0; i < size_; ++i) {
-        alloc_.construct(&new_data[i], std::move(data_[i]));
-        alloc_.destroy(&data_[i]);
-    }
+    relocate(data_, size_, new_data);
     if (data_) {
         alloc_.deallocate(data_, capacity_);
     }
@@ -50,35 +162,62 @@ void DynamicArray<T>::reserve(size_t new_cap) {
 template <typename T>
 void DynamicArray<T>::resize(size_t new_size) {
     if (new_size < size_) {
-        for (size_t i = new_size; i < size_; ++i)
-            alloc_.destroy(&data_[i]);
+        if constexpr (!std::is_trivially_destructible_v<T>) {
+            for (size_t i = new_size; i < size_; ++i)
+                std::destroy_at(&data_[i]);
+        }
         size_ = new_size;
     } else if (new_size > size_) {
         reserve(std::max(capacity_ * 2, new_size));
-        for (size_t i = size_; i < new_size; ++i)
-            alloc_.construct(&data_[i]);
+        if constexpr (std::is_trivial_v<T>) {
+            std::memset(static_cast<void*>(data_ + size_), 0, (new_size - size_) * sizeof(T));
+        } else {
+            for (size_t i = size_; i < new_size; ++i)
+                alloc_.construct(&data_[i]);
+        }
         size_ = new_size;
     }
 }
 template <typename T>
 void DynamicArray<T>::clear() {
-    for (size_t i = 0; i < size_; ++i)
-        alloc_.destroy(&data_[i]);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t i = 0; i < size_; ++i)
+            std::destroy_at(&data_[i]);
+    }
     size_ = 0;
 }
 template <typename T>
+void DynamicArray<T>::shrink_to_fit() {
+    if (size_ == capacity_) return;
+    T* new_data = nullptr;
+    if (size_ > 0) {
+        new_data = alloc_.allocate(size_);
+        relocate(data_, size_, new_data);
+    }
+    alloc_.deallocate(data_, capacity_);
+    data_ = new_data;
+    capacity_ = size_;
+}
+template <typename T>
+typename DynamicArray<T>::iterator DynamicArray<T>::erase(const_iterator first, const_iterator last) {
+    const size_t from = static_cast<size_t>(first - cbegin());
+    const size_t count = static_cast<size_t>(last - first);
+    if (count == 0) return begin() + from;
+    std::move(data_ + from + count, data_ + size_, data_ + from);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+        for (size_t i = size_ - count; i < size_; ++i)
+            std::destroy_at(&data_[i]);
+    }
+    size_ -= count;
+    return begin() + from;
+}
+template <typename T>
 void DynamicArray<T>::push_back(const T& value) {
-    if (size_ == capacity_)
-        reserve(capacity_ == 0 ? 1 : capacity_ * 2);
-    alloc_.construct(&data_[size_], value);
-    ++size_;
+    emplace_back(value);
 }
 template <typename T>
 void DynamicArray<T>::push_back(T&& value) {
-    if (size_ == capacity_)
-        reserve(capacity_ == 0 ? 1 : capacity_ * 2);
-    alloc_.construct(&data_[size_], std::move(value));
-    ++size_;
+    emplace_back(std::move(value));
 }
 template class DynamicArray<int>;
 template class DynamicArray<Point>;
\ No newline at end of file
@@ -1,19 +1,88 @@
 #pragma once
+#include <algorithm>
 #include <cstddef>
+#include <iterator>
 #include <list>
+#include <memory>
 #include <memory_resource>
+#include <mutex>
 #include <string>
+#include <type_traits>
+#include <unordered_map>
 
-class DynamicListMemoryResource : public std::pmr::memory_resource {
+// Выделяет крупные блоки через mmap с MADV_HUGEPAGE и, при необходимости,
+// привязывает их к узлу NUMA. Мелкие запросы и отказы ядра уходят в fallback.
+// Потокобезопасен, если потокобезопасен fallback (new_delete_resource — да).
+class HugePageMemoryResource : public std::pmr::memory_resource {
+public:
+    // Итог советов ядру: madvise и mbind могут не сработать, и это видно только здесь.
+    struct Stats {
+        size_t mapped = 0;        // блоков, выделенных через mmap
+        size_t huge_advised = 0;  // из них ядро приняло MADV_HUGEPAGE
+        size_t numa_bound = 0;    // из них успешно привязаны к numa_node
+        size_t numa_failed = 0;   // mbind вернул ошибку
+        size_t fallback = 0;      // запросов, ушедших в fallback
+    };
+
+private:
+    static constexpr size_t kHugePageSize = size_t(2) << 20;
+
+    std::pmr::memory_resource* fallback_;
+    size_t min_bytes_;
+    int numa_node_;
+    mutable std::mutex mutex_;
+    std::unordered_map<void*, size_t> mapped_;
+    Stats stats_;
+
+protected:
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+public:
+    explicit HugePageMemoryResource(int numa_node = -1,
+                                    size_t min_bytes = kHugePageSize,
+                                    std::pmr::memory_resource* fallback = std::pmr::new_delete_resource())
+        : fallback_(fallback), min_bytes_(min_bytes), numa_node_(numa_node) {}
+
+    HugePageMemoryResource(const HugePageMemoryResource&) = delete;
+    HugePageMemoryResource& operator=(const HugePageMemoryResource&) = delete;
+
+    ~HugePageMemoryResource() override;
+
+    size_t mapped_count() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return mapped_.size();
+    }
+    Stats stats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return stats_;
+    }
+};
+
+// Ресурс, умеющий расширять уже выделенный блок без перемещения.
+// Контейнер получает этот интерфейс при конструировании и не делает dynamic_cast.
+class InPlaceExpandable {
+public:
+    virtual bool try_expand(void* p, size_t old_bytes, size_t new_bytes) = 0;
+
+protected:
+    ~InPlaceExpandable() = default;
+};
+
+class DynamicListMemoryResource : public std::pmr::memory_resource, public InPlaceExpandable {
 private:
     struct Block {
         void* ptr;
         size_t size;
-        Block(void* p, size_t s) : ptr(p), size(s) {}
+        size_t capacity;
+        Block(void* p, size_t s) : ptr(p), size(s), capacity(s) {}
+        Block(void* p, size_t s, size_t c) : ptr(p), size(s), capacity(c) {}
     };
 
     std::list<Block> allocated_;
     std::list<Block> free_pool_;
+    std::pmr::memory_resource* upstream_;
 
 protected:
     void* do_allocate(size_t bytes, size_t alignment) override;
@@ -21,8 +90,17 @@ protected:
     bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
 
 public:
+    explicit DynamicListMemoryResource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {}
+
+    DynamicListMemoryResource(const DynamicListMemoryResource&) = delete;
+    DynamicListMemoryResource& operator=(const DynamicListMemoryResource&) = delete;
+
     ~DynamicListMemoryResource() override;
 
+    // Расширяет ранее выделенный блок без перемещения, если его реальная ёмкость позволяет.
+    bool try_expand(void* p, size_t old_bytes, size_t new_bytes) override;
+
     size_t allocated_count() const { return allocated_.size(); }
     size_t free_pool_count() const { return free_pool_.size(); }
 };
@@ -31,19 +109,36 @@ template <typename T>
 class DynamicArrayIterator {
     T* ptr_;
 public:
-    using iterator_category = std::forward_iterator_tag;
-    using value_type        = T;
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept  = std::contiguous_iterator_tag;
+    using value_type        = std::remove_cv_t<T>;
     using difference_type   = std::ptrdiff_t;
     using pointer           = T*;
     using reference         = T&;
 
     explicit DynamicArrayIterator(T* p = nullptr) : ptr_(p) {}
 
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    DynamicArrayIterator(const DynamicArrayIterator<U>& other) : ptr_(other.operator->()) {}
+
     reference operator*() const { return *ptr_; }
     pointer operator->() const { return ptr_; }
+    reference operator[](difference_type n) const { return ptr_[n]; }
 
     DynamicArrayIterator& operator++() { ++ptr_; return *this; }
     DynamicArrayIterator operator++(int) { auto tmp = *this; ++(*this); return tmp; }
+    DynamicArrayIterator& operator--() { --ptr_; return *this; }
+    DynamicArrayIterator operator--(int) { auto tmp = *this; --(*this); return tmp; }
+
+    DynamicArrayIterator& operator+=(difference_type n) { ptr_ += n; return *this; }
+    DynamicArrayIterator& operator-=(difference_type n) { ptr_ -= n; return *this; }
+
+    friend DynamicArrayIterator operator+(DynamicArrayIterator it, difference_type n) { return it += n; }
+    friend DynamicArrayIterator operator+(difference_type n, DynamicArrayIterator it) { return it += n; }
+    friend DynamicArrayIterator operator-(DynamicArrayIterator it, difference_type n) { return it -= n; }
+    friend difference_type operator-(const DynamicArrayIterator& a, const DynamicArrayIterator& b) {
+        return a.ptr_ - b.ptr_;
+    }
 
     friend bool operator==(const DynamicArrayIterator& a, const DynamicArrayIterator& b) {
         return a.ptr_ == b.ptr_;
@@ -51,6 +146,18 @@ public:
     friend bool operator!=(const DynamicArrayIterator& a, const DynamicArrayIterator& b) {
         return !(a == b);
     }
+    friend bool operator<(const DynamicArrayIterator& a, const DynamicArrayIterator& b) {
+        return a.ptr_ < b.ptr_;
+    }
+    friend bool operator>(const DynamicArrayIterator& a, const DynamicArrayIterator& b) {
+        return b < a;
+    }
+    friend bool operator<=(const DynamicArrayIterator& a, const DynamicArrayIterator& b) {
+        return !(b < a);
+    }
+    friend bool operator>=(const DynamicArrayIterator& a, const DynamicArrayIterator& b) {
+        return !(a < b);
+    }
 };
 
 template <typename T>
@@ -61,6 +168,12 @@ class DynamicArray {
     size_t size_ = 0;
     size_t capacity_ = 0;
     Allocator alloc_;
+    InPlaceExpandable* expander_ = nullptr;
+
+    // Переносит n элементов из src в неинициализированную память dst.
+    void relocate(T* src, size_t n, T* dst);
+    size_t grow_to(size_t min_cap) const { return std::max(capacity_ * 2, min_cap); }
+    bool try_grow_in_place(size_t new_cap);
 
 public:
     using value_type = T;
@@ -70,12 +183,17 @@ public:
     explicit DynamicArray(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
         : alloc_(mr) {}
 
+    template <typename MR,
+              std::enable_if_t<std::is_base_of_v<std::pmr::memory_resource, MR> &&
+                               std::is_base_of_v<InPlaceExpandable, MR>, int> = 0>
+    explicit DynamicArray(MR* mr) : alloc_(mr), expander_(mr) {}
+
     DynamicArray(const DynamicArray& other) = delete;
     DynamicArray& operator=(const DynamicArray& other) = delete;
 
     DynamicArray(DynamicArray&& other) noexcept
         : data_(other.data_), size_(other.size_), capacity_(other.capacity_),
-          alloc_(other.alloc_.resource())
+          alloc_(other.alloc_.resource()), expander_(other.expander_)
     {
         other.data_ = nullptr;
         other.size_ = other.capacity_ = 0;
@@ -107,7 +225,51 @@ public:
     void push_back(T&& value);
     void reserve(size_t new_cap);
     void resize(size_t new_size);
+    // Для тривиальных типов: увеличивает size() без инициализации новых элементов.
+    template <typename U = T, std::enable_if_t<std::is_trivial_v<U>, int> = 0>
+    void resize_uninitialized(size_t new_size) {
+        if (new_size > capacity_)
+            reserve(std::max(capacity_ * 2, new_size));
+        size_ = new_size;
+    }
     void clear();
+    void shrink_to_fit();
+
+    template <typename... Args>
+    T& emplace_back(Args&&... args) {
+        if (size_ == capacity_) {
+            const size_t new_cap = grow_to(size_ + 1);
+            if (!try_grow_in_place(new_cap)) {
+                // Аргументы могут ссылаться на наши же элементы, поэтому новый элемент
+                // строится в новом буфере до переноса старых.
+                T* new_data = alloc_.allocate(new_cap);
+                try {
+                    alloc_.construct(&new_data[size_], std::forward<Args>(args)...);
+                } catch (...) {
+                    alloc_.deallocate(new_data, new_cap);
+                    throw;
+                }
+                relocate(data_, size_, new_data);
+                if (data_) {
+                    alloc_.deallocate(data_, capacity_);
+                }
+                data_ = new_data;
+                capacity_ = new_cap;
+                return data_[size_++];
+            }
+        }
+        alloc_.construct(&data_[size_], std::forward<Args>(args)...);
+        return data_[size_++];
+    }
+
+    template <typename It>
+    iterator insert(const_iterator pos, It first, It last);
+
+    template <typename It>
+    void append(It first, It last) { insert(cend(), first, last); }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+    iterator erase(const_iterator first, const_iterator last);
 
     size_t size() const { return size_; }
     size_t capacity() const { return capacity_; }
@@ -123,8 +285,61 @@ public:
     iterator end() { return iterator(data_ + size_); }
     const_iterator begin() const { return const_iterator(data_); }
     const_iterator end() const { return const_iterator(data_ + size_); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
 };
 
+template <typename T>
+template <typename It>
+typename DynamicArray<T>::iterator DynamicArray<T>::insert(const_iterator pos, It first, It last) {
+    static_assert(std::is_base_of_v<std::forward_iterator_tag,
+                                    typename std::iterator_traits<It>::iterator_category>,
+                  "insert requires forward iterators");
+    const size_t idx = static_cast<size_t>(pos - cbegin());
+    const size_t n = static_cast<size_t>(std::distance(first, last));
+    if (n == 0) return begin() + idx;
+
+    if (size_ + n > capacity_) {
+        // Одна реаллокация: префикс, новые элементы и хвост сразу попадают на свои места.
+        // Новые элементы строятся первыми: [first, last) может указывать в наш же буфер.
+        const size_t new_cap = grow_to(size_ + n);
+        T* new_data = alloc_.allocate(new_cap);
+        size_t built = 0;
+        try {
+            for (; built < n; ++built, ++first)
+                alloc_.construct(&new_data[idx + built], *first);
+        } catch (...) {
+            for (size_t i = 0; i < built; ++i)
+                std::destroy_at(&new_data[idx + i]);
+            alloc_.deallocate(new_data, new_cap);
+            throw;
+        }
+        relocate(data_, idx, new_data);
+        relocate(data_ + idx, size_ - idx, new_data + idx + n);
+        if (data_) {
+            alloc_.deallocate(data_, capacity_);
+        }
+        data_ = new_data;
+        capacity_ = new_cap;
+    } else {
+        // Сдвигаем хвост на n позиций вправо, начиная с конца.
+        for (size_t i = size_; i-- > idx;) {
+            if (i + n >= size_)
+                alloc_.construct(&data_[i + n], std::move(data_[i]));
+            else
+                data_[i + n] = std::move(data_[i]);
+        }
+        for (size_t i = 0; i < n; ++i, ++first) {
+            if (idx + i < size_)
+                data_[idx + i] = *first;
+            else
+                alloc_.construct(&data_[idx + i], *first);
+        }
+    }
+    size_ += n;
+    return begin() + idx;
+}
+
 struct Point {
     int x = 0, y = 0;
     std::string name;
@@ -1,5 +1,8 @@
 #include "func.h"
 #include <gtest/gtest.h>
+#include <algorithm>
+#include <thread>
+#include <vector>
 
 TEST(MemoryResourceTest, ReuseBlocks) {
     DynamicListMemoryResource mr;
@@ -89,4 +92,211 @@ TEST(DynamicArrayTest, MoveAssignment) {
     EXPECT_EQ(b[0], 1);
     EXPECT_EQ(a.size(), 0);
     EXPECT_EQ(a.data(), nullptr);
-}
\ No newline at end of file
+}
+TEST(DynamicArrayTest, RandomAccessIterator) {
+    DynamicListMemoryResource mr;
+    DynamicArray<int> arr(&mr);
+    for (int v : {5, 3, 9, 1, 7}) arr.push_back(v);
+
+    auto first = arr.begin();
+    auto last = arr.end();
+    EXPECT_EQ(last - first, 5);
+    EXPECT_EQ(std::distance(first, last), 5);
+    EXPECT_EQ(first[2], 9);
+    EXPECT_EQ(*(first + 4), 7);
+    EXPECT_EQ(*(last - 1), 7);
+    EXPECT_TRUE(first < last);
+    EXPECT_EQ(&*(first + 3), arr.data() + 3);
+
+    std::sort(arr.begin(), arr.end());
+    EXPECT_TRUE(std::is_sorted(arr.begin(), arr.end()));
+    auto it = std::lower_bound(arr.begin(), arr.end(), 6);
+    EXPECT_EQ(*it, 7);
+    EXPECT_EQ(it - arr.begin(), 3);
+
+    DynamicArray<int>::const_iterator cit = arr.begin();
+    EXPECT_EQ(*cit, 1);
+    static_assert(std::is_same_v<std::iterator_traits<DynamicArray<int>::iterator>::iterator_category,
+                                 std::random_access_iterator_tag>);
+    static_assert(std::contiguous_iterator<DynamicArray<int>::iterator>);
+    static_assert(std::contiguous_iterator<DynamicArray<int>::const_iterator>);
+}
+TEST(DynamicArrayTest, ReserveKeepsValues) {
+    DynamicListMemoryResource mr;
+    DynamicArray<int> ints(&mr);
+    DynamicArray<Point> pts(&mr);
+    for (int i = 0; i < 100; ++i) {
+        ints.push_back(i);
+        pts.push_back(Point{i, -i, std::to_string(i)});
+    }
+    for (int i = 0; i < 100; ++i) {
+        EXPECT_EQ(ints[i], i);
+        EXPECT_EQ(pts[i].y, -i);
+        EXPECT_EQ(pts[i].name, std::to_string(i));
+    }
+}
+TEST(DynamicArrayTest, GrowInPlaceFromPooledBlock) {
+    DynamicListMemoryResource mr;
+    {
+        DynamicArray<int> big(&mr);
+        big.reserve(64);
+    }
+    DynamicArray<int> arr(&mr);
+    arr.reserve(4);
+    int* before = arr.data();
+    arr.push_back(1);
+    arr.reserve(32);
+    EXPECT_EQ(arr.data(), before);
+    EXPECT_EQ(arr.capacity(), 32);
+    EXPECT_EQ(arr[0], 1);
+    EXPECT_EQ(mr.allocated_count(), 1);
+}
+TEST(DynamicArrayTest, ResizeTrivial) {
+    DynamicListMemoryResource mr;
+    DynamicArray<int> arr(&mr);
+    arr.push_back(7);
+    arr.resize(5);
+    EXPECT_EQ(arr[0], 7);
+    EXPECT_EQ(arr[4], 0);
+    arr.resize_uninitialized(10);
+    EXPECT_EQ(arr.size(), 10);
+    EXPECT_EQ(arr[0], 7);
+}
+TEST(DynamicArrayTest, EmplaceBack) {
+    DynamicListMemoryResource mr;
+    DynamicArray<Point> arr(&mr);
+    Point& p = arr.emplace_back(3, 4, "C");
+    EXPECT_EQ(&p, &arr[0]);
+    arr.emplace_back(5, 6, "D");
+    EXPECT_EQ(arr.size(), 2);
+    EXPECT_EQ(arr[0].name, "C");
+    EXPECT_EQ(arr[1].x, 5);
+}
+TEST(DynamicArrayTest, SelfReferenceSurvivesGrowth) {
+    DynamicListMemoryResource mr;
+    DynamicArray<Point> arr(&mr);
+    arr.emplace_back(1, 2, "first");
+    ASSERT_EQ(arr.size(), arr.capacity());
+    arr.emplace_back(arr[0]);
+    arr.push_back(arr[1]);
+    ASSERT_EQ(arr.size(), 3);
+    EXPECT_EQ(arr[1].name, "first");
+    EXPECT_EQ(arr[2].x, 1);
+
+    arr.shrink_to_fit();
+    arr.insert(arr.begin(), arr.begin(), arr.end());
+    ASSERT_EQ(arr.size(), 6);
+    for (size_t i = 0; i < arr.size(); ++i)
+        EXPECT_EQ(arr[i].name, "first");
+}
+TEST(DynamicArrayTest, AppendAndInsertRange) {
+    DynamicListMemoryResource mr;
+    DynamicArray<int> arr(&mr);
+    std::vector<int> src{1, 2, 3, 4};
+    arr.append(src.begin(), src.end());
+    EXPECT_EQ(arr.size(), 4);
+    EXPECT_EQ(arr.capacity(), 4);
+
+    std::vector<int> mid{10, 11};
+    arr.reserve(16);
+    arr.insert(arr.begin() + 1, mid.begin(), mid.end());
+    std::vector<int> expected{1, 10, 11, 2, 3, 4};
+    EXPECT_TRUE(std::equal(arr.begin(), arr.end(), expected.begin(), expected.end()));
+
+    DynamicArray<Point> pts(&mr);
+    pts.emplace_back(0, 0, "O");
+    pts.emplace_back(9, 9, "Z");
+    std::vector<Point> more{{1, 1, "A"}, {2, 2, "B"}, {3, 3, "C"}};
+    auto it = pts.insert(pts.begin() + 1, more.begin(), more.end());
+    EXPECT_EQ(it->name, "A");
+    ASSERT_EQ(pts.size(), 5);
+    EXPECT_EQ(pts[0].name, "O");
+    EXPECT_EQ(pts[3].name, "C");
+    EXPECT_EQ(pts[4].name, "Z");
+
+    pts.reserve(10);
+    pts.insert(pts.end() - 1, more.begin(), more.begin() + 1);
+    EXPECT_EQ(pts[4].name, "A");
+    EXPECT_EQ(pts[5].name, "Z");
+}
+TEST(DynamicArrayTest, EraseAndShrink) {
+    DynamicListMemoryResource mr;
+    DynamicArray<Point> arr(&mr);
+    for (int i = 0; i < 6; ++i) arr.emplace_back(i, i, std::to_string(i));
+
+    auto it = arr.erase(arr.begin() + 1, arr.begin() + 3);
+    EXPECT_EQ(it->name, "3");
+    ASSERT_EQ(arr.size(), 4);
+    EXPECT_EQ(arr[0].name, "0");
+    EXPECT_EQ(arr[1].name, "3");
+    EXPECT_EQ(arr[3].name, "5");
+
+    arr.erase(arr.begin());
+    EXPECT_EQ(arr[0].name, "3");
+    EXPECT_EQ(arr.size(), 3);
+
+    arr.shrink_to_fit();
+    EXPECT_EQ(arr.capacity(), 3);
+    EXPECT_EQ(arr[2].name, "5");
+
+    arr.clear();
+    arr.shrink_to_fit();
+    EXPECT_EQ(arr.capacity(), 0);
+    EXPECT_EQ(arr.data(), nullptr);
+}
+TEST(HugePageMemoryResourceTest, LargeBlocksAreMapped) {
+    HugePageMemoryResource huge;
+    std::pmr::polymorphic_allocator<char> alloc(&huge);
+
+    char* small = alloc.allocate(128);
+    EXPECT_EQ(huge.mapped_count(), 0);
+
+    const size_t big_size = size_t(4) << 20;
+    char* big = alloc.allocate(big_size);
+    ASSERT_NE(big, nullptr);
+    big[0] = 1;
+    big[big_size - 1] = 2;
+#if defined(__linux__)
+    EXPECT_EQ(huge.mapped_count(), 1);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(big) % (size_t(2) << 20), 0u);
+    HugePageMemoryResource::Stats stats = huge.stats();
+    EXPECT_EQ(stats.mapped, 1u);
+    EXPECT_LE(stats.huge_advised, 1u);
+    EXPECT_EQ(stats.numa_bound + stats.numa_failed, 0u);
+#endif
+    EXPECT_EQ(huge.stats().fallback, 1u);
+
+    alloc.deallocate(big, big_size);
+    alloc.deallocate(small, 128);
+    EXPECT_EQ(huge.mapped_count(), 0);
+}
+TEST(HugePageMemoryResourceTest, SharedAcrossThreads) {
+    HugePageMemoryResource huge(-1, 64 * 1024);
+    std::vector<std::thread> pool;
+    for (int t = 0; t < 4; ++t) {
+        pool.emplace_back([&huge] {
+            for (int i = 0; i < 50; ++i) {
+                void* p = huge.allocate(128 * 1024);
+                huge.deallocate(p, 128 * 1024);
+            }
+        });
+    }
+    for (auto& th : pool) th.join();
+    EXPECT_EQ(huge.mapped_count(), 0u);
+#if defined(__linux__)
+    EXPECT_EQ(huge.stats().mapped, 200u);
+#endif
+}
+TEST(HugePageMemoryResourceTest, UpstreamForDynamicList) {
+    HugePageMemoryResource huge(-1, 64 * 1024);
+    DynamicListMemoryResource mr(&huge);
+    {
+        DynamicArray<int> arr(&mr);
+        for (int i = 0; i < 100000; ++i) arr.push_back(i);
+        EXPECT_EQ(arr[99999], 99999);
+    }
+    EXPECT_EQ(mr.allocated_count(), 0);
+#if defined(__linux__)
+    EXPECT_GT(huge.mapped_count(), 0u);
+#endif
+}
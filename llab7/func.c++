@@ -5,32 +5,219 @@
 #include <fstream>
 #include <algorithm>
 #include <numeric>
+#include <array>
 
-Knight::Knight(int x, int y, const std::string& name) {
-    setPosition(x, y);
+class Logger::Ring {
+public:
+    static const size_t kCapacity = 1024;
+
+    // Вызывается только потоком-владельцем: место может лишь освободиться.
+    bool full() const {
+        return headIndex.load(std::memory_order_relaxed) - tailIndex.load(std::memory_order_acquire) == kCapacity;
+    }
+    // Вызывается только потоком-владельцем и только если !full().
+    void push(Record&& record) {
+        size_t head = headIndex.load(std::memory_order_relaxed);
+        slots[head % kCapacity] = std::move(record);
+        headIndex.store(head + 1, std::memory_order_release);
+    }
+    // Вызывается только писателем.
+    bool pop(Record& record) {
+        size_t tail = tailIndex.load(std::memory_order_relaxed);
+        if (tail == headIndex.load(std::memory_order_acquire)) return false;
+        record = std::move(slots[tail % kCapacity]);
+        tailIndex.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+    bool empty() const {
+        return tailIndex.load(std::memory_order_acquire) == headIndex.load(std::memory_order_acquire);
+    }
+
+    std::atomic<bool> closed{false};
+private:
+    std::array<Record, kCapacity> slots;
+    alignas(64) std::atomic<size_t> headIndex{0};
+    alignas(64) std::atomic<size_t> tailIndex{0};
+};
+
+void ConsoleSink::write(const std::string& text) {
+    out << text;
+}
+
+void ConsoleSink::flush() {
+    out.flush();
+}
+
+FileSink::FileSink(const std::string& filename) {
+    file.open(filename, std::ios::app);
+    if (!file.is_open()) Logger::instance().error("[ERROR] Cannot open log file " + filename + "\n");
+}
+
+void FileSink::write(const std::string& text) {
+    if (file.is_open()) file << text;
+}
+
+void FileSink::flush() {
+    if (file.is_open()) file.flush();
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() {
+    sinks.push_back(std::make_shared<ConsoleSink>());
+    errorSink = std::make_shared<ConsoleSink>(std::cerr);
+    writer = std::thread(&Logger::writerLoop, this);
+}
+
+Logger::~Logger() {
+    stopping = true;
+    if (writer.joinable()) writer.join();
+}
+
+Logger::Ring& Logger::localRing() {
+    // Буфер регистрируется при первой записи потока и закрывается при его завершении;
+    // писатель освобождает его, когда дочитает.
+    struct Holder {
+        std::shared_ptr<Ring> ring;
+        ~Holder() { if (ring) ring->closed = true; }
+    };
+    thread_local Holder holder;
+    if (!holder.ring) {
+        holder.ring = std::make_shared<Ring>();
+        std::lock_guard lock(registryMutex);
+        rings.push_back(holder.ring);
+    }
+    return *holder.ring;
+}
+
+void Logger::push(std::string text, std::shared_ptr<LogSink> target) {
+    Ring& ring = localRing();
+    // Номер берётся только для принятой записи, иначе писатель ждал бы пропуск вечно.
+    if (ring.full()) {
+        droppedCount.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    ring.push({nextSeq.fetch_add(1, std::memory_order_relaxed), std::move(text), std::move(target)});
+}
+
+void Logger::log(std::string text) {
+    push(std::move(text), nullptr);
+}
+
+void Logger::log(std::shared_ptr<LogSink> target, std::string text) {
+    push(std::move(text), std::move(target));
+}
+
+void Logger::error(std::string text) {
+    push(std::move(text), errorSink);
+}
+
+void Logger::flush() {
+    uint64_t target = nextSeq.load();
+    std::unique_lock lock(flushMutex);
+    flushedCV.wait(lock, [&] { return written.load(std::memory_order_acquire) >= target; });
+}
+
+void Logger::addSink(std::shared_ptr<LogSink> sink) {
+    std::lock_guard lock(sinkMutex);
+    sinks.push_back(std::move(sink));
+}
+
+std::vector<std::shared_ptr<LogSink>> Logger::setSinks(std::vector<std::shared_ptr<LogSink>> newSinks) {
+    flush();
+    std::lock_guard lock(sinkMutex);
+    std::swap(sinks, newSinks);
+    return newSinks;
+}
+
+bool Logger::drainOnce(std::vector<Record>& batch, bool force) {
+    // Номер выдаётся до записи в буфер, поэтому запись может опередить более раннюю
+    // из другого потока. Такие ждут в куче pending, пока не закроется пропуск.
+    auto later = [](const Record& a, const Record& b) { return a.seq > b.seq; };
+    {
+        std::lock_guard lock(registryMutex);
+        for (auto& ring : rings) {
+            Record record;
+            while (ring->pop(record)) {
+                pending.push_back(std::move(record));
+                std::push_heap(pending.begin(), pending.end(), later);
+            }
+        }
+        rings.erase(std::remove_if(rings.begin(), rings.end(),
+            [](const std::shared_ptr<Ring>& r) { return r->closed && r->empty(); }), rings.end());
+    }
+
+    batch.clear();
+    uint64_t next = written.load(std::memory_order_relaxed);
+    while (!pending.empty() && (force || pending.front().seq == next)) {
+        std::pop_heap(pending.begin(), pending.end(), later);
+        next = std::max(next, pending.back().seq + 1);
+        batch.push_back(std::move(pending.back()));
+        pending.pop_back();
+    }
+    if (batch.empty()) return false;
+
+    {
+        std::lock_guard lock(sinkMutex);
+        std::vector<LogSink*> targets;
+        for (auto& record : batch) {
+            if (!record.target) {
+                for (auto& sink : sinks) sink->write(record.text);
+                continue;
+            }
+            record.target->write(record.text);
+            if (std::find(targets.begin(), targets.end(), record.target.get()) == targets.end()) {
+                targets.push_back(record.target.get());
+            }
+        }
+        for (auto& sink : sinks) sink->flush();
+        for (LogSink* target : targets) target->flush();
+    }
     {
-        std::unique_lock lock(mtx);
-        this->name = name;
-        this->alive = true;
+        std::lock_guard lock(flushMutex);
+        written.store(next, std::memory_order_release);
+    }
+    flushedCV.notify_all();
+    return true;
+}
+
+void Logger::writerLoop() {
+    std::vector<Record> batch;
+    while (!stopping) {
+        if (!drainOnce(batch, false)) std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
+    while (drainOnce(batch, false)) {}
+    drainOnce(batch, true);
+}
+
+Position NPC::randomStep(Position from) const {
+    thread_local static std::mt19937 gen(std::random_device{}());
+    thread_local static std::uniform_int_distribution<> dir(-1, 1);
+    int d = getMoveDistance();
+    int nx = std::clamp(from.x + dir(gen) * d, 0, MAP_WIDTH - 1);
+    int ny = std::clamp(from.y + dir(gen) * d, 0, MAP_HEIGHT - 1);
+    return {nx, ny};
+}
+
+Knight::Knight(int x, int y, const std::string& name) {
+    setPosition(x, y);
+    this->name = name;
 }
 
 double Knight::distanceTo(const std::shared_ptr<NPC>& other) const {
-    int dx = getX() - other->getX();
-    int dy = getY() - other->getY();
+    Position a = getPosition(), b = other->getPosition();
+    int dx = a.x - b.x;
+    int dy = a.y - b.y;
     return std::sqrt(dx*dx + dy*dy);
 }
 
 void Knight::moveRandom() {
     if (!isAlive()) return;
-    thread_local static std::mt19937 gen(std::random_device{}());
-    thread_local static std::uniform_int_distribution<> dir(-1, 1);
-    int d = getMoveDistance();
-    int nx = getX() + dir(gen) * d;
-    int ny = getY() + dir(gen) * d;
-    nx = std::clamp(nx, 0, MAP_WIDTH - 1);
-    ny = std::clamp(ny, 0, MAP_HEIGHT - 1);
-    setPosition(nx, ny);
+    Position p = randomStep(getPosition());
+    setPosition(p.x, p.y);
 }
 
 void Knight::accept(Visitor& v, std::shared_ptr<NPC> o) {
@@ -39,28 +226,19 @@ void Knight::accept(Visitor& v, std::shared_ptr<NPC> o) {
 
 Elf::Elf(int x, int y, const std::string& name) {
     setPosition(x, y);
-    {
-        std::unique_lock lock(mtx);
-        this->name = name;
-        this->alive = true;
-    }
+    this->name = name;
 }
 double Elf::distanceTo(const std::shared_ptr<NPC>& other) const {
-    int dx = getX() - other->getX();
-    int dy = getY() - other->getY();
+    Position a = getPosition(), b = other->getPosition();
+    int dx = a.x - b.x;
+    int dy = a.y - b.y;
     return std::sqrt(dx*dx + dy*dy);
 }
 
 void Elf::moveRandom() {
     if (!isAlive()) return;
-    thread_local static std::mt19937 gen(std::random_device{}());
-    thread_local static std::uniform_int_distribution<> dir(-1, 1);
-    int d = getMoveDistance();
-    int nx = getX() + dir(gen) * d;
-    int ny = getY() + dir(gen) * d;
-    nx = std::clamp(nx, 0, MAP_WIDTH - 1);
-    ny = std::clamp(ny, 0, MAP_HEIGHT - 1);
-    setPosition(nx, ny);
+    Position p = randomStep(getPosition());
+    setPosition(p.x, p.y);
 }
 
 void Elf::accept(Visitor& v, std::shared_ptr<NPC> o) {
@@ -69,35 +247,25 @@ void Elf::accept(Visitor& v, std::shared_ptr<NPC> o) {
 
 Dragon::Dragon(int x, int y, const std::string& name) {
     setPosition(x, y);
-    {
-        std::unique_lock lock(mtx);
-        this->name = name;
-        this->alive = true;
-    }
+    this->name = name;
 }
 
 double Dragon::distanceTo(const std::shared_ptr<NPC>& other) const {
-    int dx = getX() - other->getX();
-    int dy = getY() - other->getY();
+    Position a = getPosition(), b = other->getPosition();
+    int dx = a.x - b.x;
+    int dy = a.y - b.y;
     return std::sqrt(dx*dx + dy*dy);
 }
 void Dragon::moveRandom() {
     if (!isAlive()) return;
-    thread_local static std::mt19937 gen(std::random_device{}());
-    thread_local static std::uniform_int_distribution<> dir(-1, 1);
-    int d = getMoveDistance();
-    int nx = getX() + dir(gen) * d;
-    int ny = getY() + dir(gen) * d;
-    nx = std::clamp(nx, 0, MAP_WIDTH - 1);
-    ny = std::clamp(ny, 0, MAP_HEIGHT - 1);
-    setPosition(nx, ny);
+    Position p = randomStep(getPosition());
+    setPosition(p.x, p.y);
 }
 
 void Dragon::accept(Visitor& v, std::shared_ptr<NPC> o) {
     v.visitDragon(std::static_pointer_cast<Dragon>(shared_from_this()), o);
 }
-BattleVisitor::BattleVisitor(std::queue<BattleTask>& q, std::mutex& m, std::condition_variable& cv)
-    : battleQueue(q), queueMutex(m), queueCV(cv) {}
+BattleVisitor::BattleVisitor(std::vector<BattleTask>& engagements) : engagements(engagements) {}
 
 void BattleVisitor::addObserver(std::shared_ptr<Observer> obs) {
     observers.push_back(obs);
@@ -107,60 +275,36 @@ void BattleVisitor::notifyKill(const std::string& k, const std::string& v) {
     for (auto& obs : observers) obs->onKill(k, v);
 }
 
+bool BattleVisitor::inRange(const NPC& self, const NPC& other) const {
+    Position a = positionOf(self), b = positionOf(other);
+    int dx = a.x - b.x;
+    int dy = a.y - b.y;
+    return dx*dx + dy*dy <= self.getKillDistance()*self.getKillDistance();
+}
+
 void BattleVisitor::visitKnight(std::shared_ptr<Knight> self, std::shared_ptr<NPC> other) {
     if (!self->isAlive() || !other->isAlive()) return;
-    int dx = self->getX() - other->getX();
-    int dy = self->getY() - other->getY();
-    if (dx*dx + dy*dy <= self->getKillDistance()*self->getKillDistance() && other->getType() == "Dragon") {
-        {
-            std::lock_guard lock(queueMutex);
-            battleQueue.emplace(self, other);  
-        }
-        queueCV.notify_one();
-    }
+    if (other->getKind() == NPCKind::Dragon && inRange(*self, *other)) engagements.emplace_back(self, other);
 }
 
 void BattleVisitor::visitElf(std::shared_ptr<Elf> self, std::shared_ptr<NPC> other) {
     if (!self->isAlive() || !other->isAlive()) return;
-    int dx = self->getX() - other->getX();
-    int dy = self->getY() - other->getY();
-    if (dx*dx + dy*dy <= self->getKillDistance()*self->getKillDistance() && other->getType() == "Knight") {
-        {
-            std::lock_guard lock(queueMutex);
-            battleQueue.emplace(self, other);
-        }
-        queueCV.notify_one();
-    }
+    if (other->getKind() == NPCKind::Knight && inRange(*self, *other)) engagements.emplace_back(self, other);
 }
 
 void BattleVisitor::visitDragon(std::shared_ptr<Dragon> self, std::shared_ptr<NPC> other) {
     if (!self->isAlive() || !other->isAlive()) return;
-    int dx = self->getX() - other->getX();
-    int dy = self->getY() - other->getY();
-    if (dx*dx + dy*dy <= self->getKillDistance()*self->getKillDistance() && other->getType() == "Elf") {
-        {
-            std::lock_guard lock(queueMutex);
-            battleQueue.emplace(self, other);
-        }
-        queueCV.notify_one();
-    }
+    if (other->getKind() == NPCKind::Elf && inRange(*self, *other)) engagements.emplace_back(self, other);
 }
 
 void ConsoleObserver::onKill(const std::string& k, const std::string& v) {
-    std::lock_guard lock(OutputMutex::getCoutMutex());
-    std::cout << "[KILL] " << k << " killed " << v << '\n';
+    Logger::instance().log("[KILL] " + k + " killed " + v + '\n');
 }
 
-FileObserver::FileObserver(const std::string& fname) : filename(fname) {
-    file.open(fname, std::ios::app);  // ✅ открываем
-}
+FileObserver::FileObserver(const std::string& fname) : sink(std::make_shared<FileSink>(fname)) {}
 
 void FileObserver::onKill(const std::string& k, const std::string& v) {
-    std::lock_guard lock(fileMutex);
-    if (file.is_open()) {
-        file << "[KILL] " << k << " killed " << v << '\n';
-        file.flush();
-    }
+    Logger::instance().log(sink, "[KILL] " + k + " killed " + v + '\n');
 }
 std::shared_ptr<NPC> NPCFactory::create(const std::string& type, int x, int y, const std::string& name) {
     if (type == "Knight") return std::make_shared<Knight>(x, y, name);
@@ -193,18 +337,21 @@ void NPCFactory::saveToFile(const std::string& fname, const std::vector<std::sha
     std::ofstream f(fname);
     for (auto& npc : npcs) {
         if (npc->isAlive()) {
-            f << npc->getType() << ' ' << npc->getX() << ' ' << npc->getY() << ' ' << npc->getName() << '\n';
+            Position p = npc->getPosition();
+            f << npc->getType() << ' ' << p.x << ' ' << p.y << ' ' << npc->getName() << '\n';
         }
     }
 }
 void NPCFactory::printAll(const std::vector<std::shared_ptr<NPC>>& npcs) {
-    std::lock_guard lock(OutputMutex::getCoutMutex());
+    std::ostringstream out;
     for (auto& npc : npcs) {
         if (npc->isAlive()) {
-            std::cout << npc->getType() << " (" << npc->getName() 
-                      << ") at (" << npc->getX() << ", " << npc->getY() << ")\n";
+            Position p = npc->getPosition();
+            out << npc->getType() << " (" << npc->getName() 
+                << ") at (" << p.x << ", " << p.y << ")\n";
         }
     }
+    Logger::instance().log(out.str());
 }
 
 std::vector<std::shared_ptr<NPC>> NPCFactory::createRandomNPCs(int n) {
@@ -224,66 +371,142 @@ std::vector<std::shared_ptr<NPC>> NPCFactory::createRandomNPCs(int n) {
 }
 
 void NPCFactory::printMap(const std::vector<std::shared_ptr<NPC>>& npcs) {
-    std::lock_guard lock(OutputMutex::getCoutMutex());
+    WorldSnapshot world;
+    fillSnapshot(npcs, world);
+    printMap(world);
+}
+
+void NPCFactory::printMap(const WorldSnapshot& world) {
+    Logger::instance().log(formatMap(world));
+}
+
+std::string NPCFactory::formatMap(const WorldSnapshot& world) {
+    std::ostringstream out;
     int sw = MAP_WIDTH / MAP_SCALE, sh = MAP_HEIGHT / MAP_SCALE;
     std::vector<std::vector<char>> map(sh, std::vector<char>(sw, '.'));
     std::vector<std::vector<int>> cnt(sh, std::vector<int>(sw, 0));
-    for (auto& npc : npcs) {
-        if (!npc->isAlive()) continue;
-        int x = npc->getX() / MAP_SCALE;
-        int y = npc->getY() / MAP_SCALE;
+    for (auto& npc : world.npcs) {
+        if (!npc.alive) continue;
+        int x = npc.x / MAP_SCALE;
+        int y = npc.y / MAP_SCALE;
         if (x < 0 || x >= sw || y < 0 || y >= sh) continue;
         cnt[y][x]++;
-        if (cnt[y][x] == 1) map[y][x] = npc->getMapSymbol();
+        if (cnt[y][x] == 1) map[y][x] = npc.symbol;
         else if (cnt[y][x] == 2) map[y][x] = '2';
         else if (cnt[y][x] <= 9) map[y][x] = '0' + cnt[y][x];
         else map[y][x] = '+';
     }
 
-    std::cout << "\n=== MAP (" << MAP_WIDTH << "x" << MAP_HEIGHT << " scaled to " 
-              << sw << "x" << sh << ") ===\n";
+    out << "\n=== MAP (" << MAP_WIDTH << "x" << MAP_HEIGHT << " scaled to " 
+        << sw << "x" << sh << ") ===\n";
     for (int i = 0; i < sh; ++i) {
-        std::cout << '|';
-        for (int j = 0; j < sw; ++j) std::cout << map[i][j];
-        std::cout << "|\n";
+        out << '|';
+        for (int j = 0; j < sw; ++j) out << map[i][j];
+        out << "|\n";
     }
 
-    int alive = 0, cells = 0, maxc = 0;
-    std::map<std::string, int> types;
-    for (auto& npc : npcs) {
-        if (npc->isAlive()) {
-            alive++;
-            types[npc->getType()]++;
-        }
-    }
+    int cells = 0, maxc = 0;
     for (int i = 0; i < sh; ++i)
         for (int j = 0; j < sw; ++j) {
             if (cnt[i][j] > 0) { cells++; maxc = std::max(maxc, cnt[i][j]); }
         }
 
-    std::cout << "NPCs: " << alive << " | Occupied cells: " << cells 
-              << "/" << (sw * sh) << " | Max in cell: " << maxc << "\n";
-    std::cout << "Legend: K-Knight, E-Elf, D-Dragon, 2-9-count, +-10+\n";
+    out << "NPCs: " << world.alive << " | Occupied cells: " << cells 
+        << "/" << (sw * sh) << " | Max in cell: " << maxc << "\n";
+    out << "Legend: K-Knight, E-Elf, D-Dragon, 2-9-count, +-10+\n";
+    return out.str();
+}
+
+void NPCFactory::printDetailedStats(const Population& population, size_t total) {
+    static const auto types = getAvailableTypes();
+    std::ostringstream out;
+    out << "\n=== NPC DETAILS ===\n";
+    out << "Total alive: " << population.total() << "/" << total << "\n";
+    for (int k = 0; k < NPC_KIND_COUNT; ++k) {
+        int c = population.alive(static_cast<NPCKind>(k));
+        if (c > 0) out << types[k] << ": " << c << "\n";
+    }
+    Logger::instance().log(out.str());
+}
+WorldBuffer::ReadGuard WorldBuffer::read() const {
+    for (;;) {
+        int index = front.load();
+        readers[index].fetch_add(1);
+        // Повторная проверка: если буфер успели сменить, писатель мог уже начать его перезапись.
+        if (front.load() == index) return ReadGuard(*this, index);
+        readers[index].fetch_sub(1);
+    }
+}
+
+WorldSnapshot& WorldBuffer::beginWrite() {
+    // Любой скрытый буфер без читателей; читатель, опоздавший к смене индекса,
+    // увидит это при повторной проверке в read() и уйдёт.
+    int shown = front.load();
+    for (;;) {
+        for (int i = 1; i < kBuffers; ++i) {
+            int candidate = (shown + i) % kBuffers;
+            if (readers[candidate].load() == 0) {
+                back = candidate;
+                return buffers[back];
+            }
+        }
+        std::this_thread::yield();
+    }
+}
+
+void WorldBuffer::publish() {
+    front.store(back);
 }
 
-void NPCFactory::printDetailedStats(const std::vector<std::shared_ptr<NPC>>& npcs) {
-    std::lock_guard lock(OutputMutex::getCoutMutex());
-    std::map<std::string, int> cnt;
-    for (auto& npc : npcs) if (npc->isAlive()) cnt[npc->getType()]++;
-    std::cout << "\n=== NPC DETAILS ===\n";
-    std::cout << "Total alive: " << std::accumulate(cnt.begin(), cnt.end(), 0,
-        [](int s, auto& p) { return s + p.second; }) << "/" << npcs.size() << "\n";
-    for (auto& [t, c] : cnt) std::cout << t << ": " << c << "\n";
+void NPCFactory::fillSnapshot(const std::vector<std::shared_ptr<NPC>>& npcs, WorldSnapshot& world) {
+    world.npcs.resize(npcs.size());
+    world.aliveByKind.fill(0);
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        Position p = npcs[i]->getPosition();
+        bool alive = npcs[i]->isAlive();
+        world.npcs[i] = {p.x, p.y, alive, npcs[i]->getMapSymbol()};
+        if (alive) world.aliveByKind[static_cast<int>(npcs[i]->getKind())]++;
+    }
+    world.alive = 0;
+    for (int c : world.aliveByKind) world.alive += c;
 }
-Game::Game() {
-    npcs = NPCFactory::createRandomNPCs(50);
+
+// Позиции такта читаются из следующего состояния, а не из живых NPC.
+class Game::TickVisitor : public BattleVisitor {
+public:
+    explicit TickVisitor(Game& game) : BattleVisitor(game.engagements), game(game) {}
+protected:
+    Position positionOf(const NPC& npc) const override {
+        return game.nextState().positions[game.slots.at(&npc)];
+    }
+private:
+    Game& game;
+};
+
+Game::Game() : Game(NPCFactory::createRandomNPCs(50)) {}
+
+Game::Game(std::vector<std::shared_ptr<NPC>> list) : npcs(std::move(list)) {
+    observers.push_back(std::make_shared<ConsoleObserver>());
+    observers.push_back(std::make_shared<FileObserver>("log.txt"));
+    TickState& state = states[current];
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        slots[npcs[i].get()] = i;
+        state.positions.push_back(npcs[i]->getPosition());
+        state.alive.push_back(npcs[i]->isAlive());
+    }
     {
-        std::lock_guard lock(OutputMutex::getCoutMutex());
-        std::cout << "[GAME] Created " << npcs.size() << " NPCs\n";
-        std::map<std::string, int> cnt;
-        for (auto& n : npcs) cnt[n->getType()]++;
-        for (auto& [t, c] : cnt) std::cout << "[GAME] " << t << ": " << c << "\n";
+        for (auto& n : npcs) n->joinPopulation(population);
+        auto types = NPCFactory::getAvailableTypes();
+        std::ostringstream out;
+        out << "[GAME] Created " << npcs.size() << " NPCs\n";
+        for (int k = 0; k < NPC_KIND_COUNT; ++k) {
+            int c = population->alive(static_cast<NPCKind>(k));
+            if (c > 0) out << "[GAME] " << types[k] << ": " << c << "\n";
+        }
+        Logger::instance().log(out.str());
     }
+    nextState() = state;
+    publish();
 }
 
 Game::~Game() {
@@ -292,26 +515,35 @@ Game::~Game() {
 
 void Game::start() {
     running = true;
-    movementThreadObj = std::thread(&Game::movementThread, this);
+    // battleThread создаётся первым: movementThread проверяет его при разборе боёв.
     battleThreadObj = std::thread(&Game::battleThread, this);
+    movementThreadObj = std::thread(&Game::movementThread, this);
     mainThreadObj = std::thread(&Game::mainThread, this);
 
-    std::lock_guard lock(OutputMutex::getCoutMutex());
-    std::cout << "\n=== GAME STARTED ===\n";
-    std::cout << "Duration: " << GAME_DURATION << " seconds\n";
-    std::cout << "NPCs: Knight (move:30/kill:10), Elf (10/50), Dragon (50/30)\n";
-    std::cout << "Main thread will update every second...\n";
+    std::ostringstream out;
+    out << "\n=== GAME STARTED ===\n";
+    out << "Duration: " << GAME_DURATION << " seconds\n";
+    out << "NPCs: Knight (move:30/kill:10), Elf (10/50), Dragon (50/30)\n";
+    out << "Main thread will update every second...\n";
+    Logger::instance().log(out.str());
 }
 
-void Game::stop() {
+void Game::halt() {
+    std::lock_guard lock(queueMutex);
     running = false;
     queueCV.notify_all();
-    
+    resolvedCV.notify_all();
+}
+
+void Game::stop() {
+    halt();
+
     if (movementThreadObj.joinable()) movementThreadObj.join();
     if (battleThreadObj.joinable()) battleThreadObj.join();
     if (mainThreadObj.joinable()) mainThreadObj.join();
 }
 void Game::mainThread() {
+    static const auto types = NPCFactory::getAvailableTypes();
     auto end = std::chrono::steady_clock::now() + std::chrono::seconds(GAME_DURATION);
     int sec = 0;
 
@@ -326,100 +558,173 @@ void Game::mainThread() {
         if (!running) break;
         sec++;
 
-        std::lock_guard lock(OutputMutex::getCoutMutex());
-        std::cout << "\n=== TIME: " << sec << "s / " << GAME_DURATION << "s ===\n";
-        NPCFactory::printMap(npcs);
+        std::ostringstream out;
+        {
+            auto view = world.read();
+            out << "\n=== TIME: " << sec << "s / " << GAME_DURATION << "s (tick " << view->tick << ") ===\n";
+            out << NPCFactory::formatMap(*view);
 
-        int alive = 0;
-        std::map<std::string, int> types;
-        for (auto& n : npcs) if (n->isAlive()) { alive++; types[n->getType()]++; }
-        std::cout << "Alive: " << alive << "/" << npcs.size() << " | ";
-        for (auto& [t, c] : types) std::cout << t << ":" << c << " ";
-        std::cout << "\n";
+            out << "Alive: " << view->alive << "/" << npcs.size() << " | ";
+            for (int k = 0; k < NPC_KIND_COUNT; ++k) {
+                if (view->aliveByKind[k] > 0) out << types[k] << ":" << view->aliveByKind[k] << " ";
+            }
+            out << "\n";
+        }
+        Logger::instance().log(out.str());
     }
-    running = false;
-    queueCV.notify_all();
+    halt();
     printFinalResults();  
 }
 
+void Game::moveAll() {
+    const TickState& now = states[current];
+    TickState& next = nextState();
+    next.alive = now.alive;
+    next.positions.resize(npcs.size());
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        next.positions[i] = now.alive[i] ? npcs[i]->randomStep(now.positions[i]) : now.positions[i];
+    }
+}
+
+void Game::detectEngagements() {
+    // Только сбор: бои начнутся, когда весь список будет готов.
+    const TickState& next = nextState();
+    TickVisitor visitor(*this);
+    for (size_t i = 0; i < npcs.size(); ++i)
+        if (next.alive[i])
+            for (size_t j = 0; j < npcs.size(); ++j)
+                if (i != j && next.alive[j])
+                    npcs[i]->accept(visitor, npcs[j]);
+}
+
+void Game::resolveBattles() {
+    std::unique_lock lock(queueMutex);
+    if (battleThreadObj.joinable()) {
+        // Весь список такта передаётся battleThread разом; такт ждёт, пока он не разобран.
+        battleQueue.swap(engagements);
+        engagements.clear();
+        queueCV.notify_one();
+        // Начатый список battleThread дорабатывает до конца даже при остановке,
+        // иначе publish() читал бы флаги, которые он ещё пишет.
+        resolvedCV.wait(lock, [this] { return !resolving && (battleQueue.empty() || !running); });
+        battleQueue.clear();
+        return;
+    }
+    lock.unlock();
+    for (const auto& task : engagements) resolveTask(task);
+    engagements.clear();
+}
+
+void Game::publish() {
+    // Следующее состояние становится текущим: живые NPC, счётчики популяции и снимок
+    // обновляются вместе, один раз за такт.
+    const TickState& next = nextState();
+    WorldSnapshot& snapshot = world.beginWrite();
+    snapshot.npcs.resize(npcs.size());
+    snapshot.aliveByKind.fill(0);
+    for (size_t i = 0; i < npcs.size(); ++i) {
+        NPC& npc = *npcs[i];
+        Position p = next.positions[i];
+        npc.setPosition(p.x, p.y);
+        if (!next.alive[i] && npc.isAlive()) npc.kill();
+        snapshot.npcs[i] = {p.x, p.y, next.alive[i] != 0, npc.getMapSymbol()};
+        if (next.alive[i]) snapshot.aliveByKind[static_cast<int>(npc.getKind())]++;
+    }
+    snapshot.alive = 0;
+    for (int c : snapshot.aliveByKind) snapshot.alive += c;
+    snapshot.tick = ++tickCount;
+    world.publish();
+    current = 1 - current;
+}
+
+void Game::tick() {
+    currentPhase = Phase::Move;
+    moveAll();
+    currentPhase = Phase::Detect;
+    detectEngagements();
+    currentPhase = Phase::Resolve;
+    resolveBattles();
+    currentPhase = Phase::Publish;
+    publish();
+    currentPhase = Phase::Idle;
+}
+
 void Game::movementThread() {
-    auto consoleObs = std::make_shared<ConsoleObserver>();
-    auto fileObs = std::make_shared<FileObserver>("log.txt");
     int iter = 0;
 
     while (running) {
         iter++;
-        BattleVisitor visitor(battleQueue, queueMutex, queueCV);
-        visitor.addObserver(consoleObs);
-        visitor.addObserver(fileObs);
-
-        for (auto& npc : npcs)
-            if (npc->isAlive()) {
-                npc->moveRandom();
-                for (auto& other : npcs)
-                    if (npc != other && other->isAlive())
-                        npc->accept(visitor, other);
-            }
+        tick();
 
         if (iter % 20 == 0) {
-            std::lock_guard lock(OutputMutex::getCoutMutex());
-            std::cout << "[MOVEMENT] Iteration " << iter << "\n";
+            Logger::instance().log("[MOVEMENT] Iteration " + std::to_string(iter) + "\n");
         }
 
         std::this_thread::sleep_for(std::chrono::milliseconds(50));
     }
 }
-void Game::battleThread() {
+
+void Game::resolveTask(const BattleTask& task) {
     thread_local static std::mt19937 gen(std::random_device{}());
     thread_local static std::uniform_int_distribution<> dice(1, 6);
-    auto consoleObs = std::make_shared<ConsoleObserver>();
-    auto fileObs = std::make_shared<FileObserver>("log.txt");
-    int n = 0;
-
-    while (running) {
-        BattleTask task(nullptr, nullptr);
-        bool got = false;
+    if (!task.attacker || !task.defender) return;
+    // Гибель пишется в следующее состояние: погибший раньше в этом же такте в боях не участвует.
+    std::vector<char>& alive = nextState().alive;
+    size_t attacker = slots.at(task.attacker.get());
+    size_t defender = slots.at(task.defender.get());
+    if (!alive[attacker] || !alive[defender]) return;
+
+    int n = ++battleCount;
+    int a = dice(gen), d = dice(gen);
+    Logger::instance().log("[BATTLE #" + std::to_string(n) + "] " + task.attacker->getName() + " vs " +
+                           task.defender->getName() + " | " + std::to_string(a) + " vs " + std::to_string(d) + "\n");
+    if (a > d) {
+        alive[defender] = 0;
+        for (auto& observer : observers) observer->onKill(task.attacker->getName(), task.defender->getName());
+        Logger::instance().log("[KILLED] " + task.defender->getName() + "\n");
+    }
+}
 
-        {
-            std::unique_lock lock(queueMutex);
-            if (queueCV.wait_for(lock, std::chrono::milliseconds(100),
-                [this] { return !battleQueue.empty() || !running; }) && running) {
-                if (!battleQueue.empty()) {
-                    task = std::move(battleQueue.front());
-                    battleQueue.pop();
-                    got = true;
-                }
-            }
-        }
-        if (got && task.attacker && task.defender && task.attacker->isAlive() && task.defender->isAlive()) {
-            n++;
-            int a = dice(gen), d = dice(gen);
-            std::lock_guard lock(OutputMutex::getCoutMutex());
-            std::cout << "[BATTLE #" << n << "] "
-                      << task.attacker->getName() << " vs " << task.defender->getName()
-                      << " | " << a << " vs " << d << "\n";
-            if (a > d) {
-                task.defender->kill();
-                consoleObs->onKill(task.attacker->getName(), task.defender->getName());
-                std::cout << "[KILLED] " << task.defender->getName() << "\n";
-            }
-        }
+void Game::battleThread() {
+    // Просыпается только на передачу списка такта из resolveBattles или на остановку.
+    std::unique_lock lock(queueMutex);
+    while (true) {
+        queueCV.wait(lock, [this] { return !battleQueue.empty() || !running; });
+        if (!running) break;
+        std::vector<BattleTask> batch;
+        batch.swap(battleQueue);
+        resolving = true;
+        lock.unlock();
+        for (const auto& task : batch) resolveTask(task);
+        lock.lock();
+        resolving = false;
+        resolvedCV.notify_all();
     }
+    resolvedCV.notify_all();
 }
 
 void Game::printFinalResults() {
-    std::lock_guard lock(OutputMutex::getCoutMutex());
-    std::cout << "\n=== GAME OVER ===\n";
-    NPCFactory::printMap(npcs);
+    std::ostringstream out;
+    auto view = world.read();
+    out << "\n=== GAME OVER ===\n";
+    out << NPCFactory::formatMap(*view);
     std::vector<std::shared_ptr<NPC>> survivors;
-    std::copy_if(npcs.begin(), npcs.end(), std::back_inserter(survivors),
-        [](auto& n) { return n->isAlive(); });
+    std::vector<size_t> indices;
+    for (size_t i = 0; i < view->npcs.size(); ++i) {
+        if (view->npcs[i].alive) {
+            survivors.push_back(npcs[i]);
+            indices.push_back(i);
+        }
+    }
 
-    std::cout << "\nSurvivors (" << survivors.size() << "):\n";
-    for (auto& s : survivors)
-        std::cout << "  " << s->getName() << " (" << s->getType() 
-                  << ") @ (" << s->getX() << ", " << s->getY() << ")\n";
+    out << "\nSurvivors (" << survivors.size() << "):\n";
+    for (size_t i : indices) {
+        const NPCSnapshot& s = view->npcs[i];
+        out << "  " << npcs[i]->getName() << " (" << npcs[i]->getType() 
+            << ") @ (" << s.x << ", " << s.y << ")\n";
+    }
 
     NPCFactory::saveToFile("survivors.txt", survivors);
-    std::cout << "\n Results saved to 'survivors.txt' and 'log.txt'\n";
+    out << "\n Results saved to 'survivors.txt' and 'log.txt'\n";
+    Logger::instance().log(out.str());
 }
\ No newline at end of file
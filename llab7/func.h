@@ -7,13 +7,15 @@
 #include <sstream>
 #include <cmath>
 #include <mutex>
-#include <shared_mutex>
 #include <random>
 #include <thread>
 #include <atomic>
 #include <queue>
 #include <condition_variable>
 #include <map>
+#include <unordered_map>
+#include <cstdint>
+#include <array>
 
 const int MAP_WIDTH = 100;
 const int MAP_HEIGHT = 100;
@@ -21,12 +23,102 @@ const int GAME_DURATION = 30;
 const int MAP_SCALE = 10;
 class Visitor;
 class Observer;
-class OutputMutex {
+// Приёмник готовых записей журнала; вызывается только из потока-писателя.
+class LogSink {
 public:
-    static std::mutex& getCoutMutex() {
-        static std::mutex coutMutex;
-        return coutMutex;
+    virtual ~LogSink() = default;
+    virtual void write(const std::string& text) = 0;
+    virtual void flush() {}
+};
+class ConsoleSink : public LogSink {
+public:
+    explicit ConsoleSink(std::ostream& out = std::cout) : out(out) {}
+    void write(const std::string& text) override;
+    void flush() override;
+private:
+    std::ostream& out;
+};
+class FileSink : public LogSink {
+public:
+    explicit FileSink(const std::string& filename);
+    void write(const std::string& text) override;
+    void flush() override;
+private:
+    std::ofstream file;
+};
+// Асинхронный журнал: у каждого потока свой SPSC-буфер готовых записей,
+// один поток-писатель собирает их по порядку номеров и отдаёт приёмникам.
+// log() не берёт блокировок и никогда не ждёт писателя: если буфер потока полон,
+// запись отбрасывается и учитывается в dropped().
+class Logger {
+public:
+    static Logger& instance();
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    void log(std::string text);
+    // Запись только в target (например, файл наблюдателя), в общем порядке журнала.
+    void log(std::shared_ptr<LogSink> target, std::string text);
+    // Сообщение об ошибке: уходит в приёмник ошибок (std::cerr), а не в общие приёмники.
+    void error(std::string text);
+    // Ждёт, пока будут записаны все записи, отправленные до вызова.
+    void flush();
+    // Число записей, отброшенных из-за переполненного буфера потока.
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+    void addSink(std::shared_ptr<LogSink> sink);
+    // Заменяет набор приёмников и возвращает прежний.
+    std::vector<std::shared_ptr<LogSink>> setSinks(std::vector<std::shared_ptr<LogSink>> newSinks);
+private:
+    Logger();
+    struct Record {
+        uint64_t seq = 0;
+        std::string text;
+        std::shared_ptr<LogSink> target;    // пусто — во все приёмники
+    };
+    class Ring;
+    Ring& localRing();
+    void push(std::string text, std::shared_ptr<LogSink> target);
+    void writerLoop();
+    bool drainOnce(std::vector<Record>& batch, bool force);
+
+    std::mutex registryMutex;
+    std::vector<std::shared_ptr<Ring>> rings;
+    std::mutex sinkMutex;
+    std::vector<std::shared_ptr<LogSink>> sinks;
+    std::shared_ptr<LogSink> errorSink;
+    std::atomic<uint64_t> nextSeq{0};
+    std::atomic<uint64_t> droppedCount{0};
+    // Все записи с номером меньше written уже отданы приёмникам.
+    std::atomic<uint64_t> written{0};
+    std::mutex flushMutex;
+    std::condition_variable flushedCV;
+    // Записи, опередившие ещё не выложенную запись с меньшим номером; только для писателя.
+    std::vector<Record> pending;
+    std::atomic<bool> stopping{false};
+    std::thread writer;
+};
+struct Position {
+    int x = 0;
+    int y = 0;
+};
+// Порядок совпадает с NPCFactory::getAvailableTypes().
+enum class NPCKind { Knight, Elf, Dragon };
+const int NPC_KIND_COUNT = 3;
+// Число живых NPC по типам: обновляется при появлении и гибели,
+// запросы — за O(1) без обхода списка.
+class Population {
+public:
+    void onSpawn(NPCKind kind) { counts[static_cast<int>(kind)].fetch_add(1, std::memory_order_relaxed); }
+    void onKill(NPCKind kind) { counts[static_cast<int>(kind)].fetch_sub(1, std::memory_order_relaxed); }
+    int alive(NPCKind kind) const { return counts[static_cast<int>(kind)].load(std::memory_order_relaxed); }
+    int total() const {
+        int sum = 0;
+        for (const auto& c : counts) sum += c.load(std::memory_order_relaxed);
+        return sum;
     }
+private:
+    std::atomic<int> counts[NPC_KIND_COUNT] = {0, 0, 0};
 };
 class NPC : public std::enable_shared_from_this<NPC> {
 public:
@@ -40,39 +132,60 @@ public:
     virtual int getMoveDistance() const = 0;
     virtual int getKillDistance() const = 0;
     virtual char getMapSymbol() const = 0;
-    int getX() const { 
-        std::shared_lock lock(mtx);
-        return x; 
-    }
-    int getY() const { 
-        std::shared_lock lock(mtx);
-        return y; 
+    virtual NPCKind getKind() const = 0;
+    // Живой NPC сразу учитывается в target; гибель уменьшает счётчик его типа.
+    // NPC состоит не более чем в одной популяции: повторный вызов выводит его из
+    // прежней. Вызывать до запуска игровых потоков.
+    void joinPopulation(std::shared_ptr<Population> target) {
+        if (population && isAlive()) population->onKill(getKind());
+        population = std::move(target);
+        if (population && isAlive()) population->onSpawn(getKind());
     }
-    const std::string& getName() const { 
-        std::shared_lock lock(mtx);
-        return name; 
+    // Обе координаты лежат в одном 64-битном атомике: чтение даёт
+    // согласованную пару без блокировок, запись — одна операция store.
+    Position getPosition() const {
+        return unpack(pos.load(std::memory_order_acquire));
     }
+    int getX() const { return getPosition().x; }
+    int getY() const { return getPosition().y; }
+    // Имя задаётся в конструкторе и дальше не меняется.
+    const std::string& getName() const { return name; }
     
     void setPosition(int newX, int newY) {
-        std::unique_lock lock(mtx);
-        x = newX;
-        y = newY;
+        pos.store(pack(newX, newY), std::memory_order_release);
     }
+    // Случайный шаг длиной getMoveDistance() из from, в пределах карты; сам NPC не меняется.
+    Position randomStep(Position from) const;
 protected:
-    mutable std::shared_mutex mtx;
-    int x = 0;
-    int y = 0;
+    static uint64_t pack(int x, int y) {
+        return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+    }
+    static Position unpack(uint64_t v) {
+        return {static_cast<int32_t>(static_cast<uint32_t>(v >> 32)), static_cast<int32_t>(static_cast<uint32_t>(v))};
+    }
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "packed position must be lock-free");
+
+    // Счётчик уменьшается только тем вызовом, который действительно убил NPC.
+    void markDead() {
+        if (alive.exchange(false, std::memory_order_acq_rel) && population) population->onKill(getKind());
+    }
+
+    std::atomic<uint64_t> pos{0};
     std::string name;
-    bool alive = true;
+    std::atomic<bool> alive{true};
+    // Владение общее: NPC может пережить Game, и поздний kill() не должен
+    // писать в освобождённую память.
+    std::shared_ptr<Population> population;
 };
 class Knight : public NPC {
 public:
     Knight(int x, int y, const std::string& name);
     void accept(Visitor& visitor, std::shared_ptr<NPC> other) override;
-    bool isAlive() const override { return alive; }
+    bool isAlive() const override { return alive.load(std::memory_order_acquire); }
     std::string getType() const override { return "Knight"; }
     char getMapSymbol() const override { return 'K'; }
-    void kill() override { alive = false; }
+    NPCKind getKind() const override { return NPCKind::Knight; }
+    void kill() override { markDead(); }
     double distanceTo(const std::shared_ptr<NPC>& other) const override;
     void moveRandom() override;
     int getMoveDistance() const override { return 30; }
@@ -82,10 +195,11 @@ class Elf : public NPC {
 public:
     Elf(int x, int y, const std::string& name);
     void accept(Visitor& visitor, std::shared_ptr<NPC> other) override;
-    bool isAlive() const override { return alive; }
+    bool isAlive() const override { return alive.load(std::memory_order_acquire); }
     std::string getType() const override { return "Elf"; }
     char getMapSymbol() const override { return 'E'; }
-    void kill() override { alive = false; }
+    NPCKind getKind() const override { return NPCKind::Elf; }
+    void kill() override { markDead(); }
     double distanceTo(const std::shared_ptr<NPC>& other) const override;
     void moveRandom() override;
     int getMoveDistance() const override { return 10; }
@@ -95,10 +209,11 @@ class Dragon : public NPC {
 public:
     Dragon(int x, int y, const std::string& name);
     void accept(Visitor& visitor, std::shared_ptr<NPC> other) override;
-    bool isAlive() const override { return alive; }
+    bool isAlive() const override { return alive.load(std::memory_order_acquire); }
     std::string getType() const override { return "Dragon"; }
     char getMapSymbol() const override { return 'D'; }
-    void kill() override { alive = false; }
+    NPCKind getKind() const override { return NPCKind::Dragon; }
+    void kill() override { markDead(); }
     double distanceTo(const std::shared_ptr<NPC>& other) const override;
     void moveRandom() override;
     int getMoveDistance() const override { return 50; }
@@ -117,22 +232,23 @@ struct BattleTask {
     BattleTask(std::shared_ptr<NPC> a, std::shared_ptr<NPC> d)
         : attacker(std::move(a)), defender(std::move(d)) {}
 };
+// Только собирает столкновения в engagements: ни блокировок, ни боёв во время обхода.
 class BattleVisitor : public Visitor {
 public:
-    BattleVisitor(std::queue<BattleTask>& battleQueue, 
-                  std::mutex& queueMutex,
-                  std::condition_variable& queueCV);
+    explicit BattleVisitor(std::vector<BattleTask>& engagements);
     void visitKnight(std::shared_ptr<Knight> self, std::shared_ptr<NPC> other) override;
     void visitElf(std::shared_ptr<Elf> self, std::shared_ptr<NPC> other) override;
     void visitDragon(std::shared_ptr<Dragon> self, std::shared_ptr<NPC> other) override;
 
     void notifyKill(const std::string& killer, const std::string& victim);
     void addObserver(std::shared_ptr<Observer> obs);
+protected:
+    // Откуда берутся координаты для проверки дистанции; Game подставляет позиции такта.
+    virtual Position positionOf(const NPC& npc) const { return npc.getPosition(); }
 private:
+    bool inRange(const NPC& self, const NPC& other) const;
     std::vector<std::shared_ptr<Observer>> observers;
-    std::queue<BattleTask>& battleQueue;
-    std::mutex& queueMutex;
-    std::condition_variable& queueCV;
+    std::vector<BattleTask>& engagements;
 };
 class Observer {
 public:
@@ -143,14 +259,59 @@ class ConsoleObserver : public Observer {
 public:
     void onKill(const std::string& killer, const std::string& victim) override;
 };
+// Пишет гибели в свой файл через Logger: запись асинхронная, порядок — общий с журналом.
 class FileObserver : public Observer {
 public:
     FileObserver(const std::string& filename = "log.txt");
     void onKill(const std::string& killer, const std::string& victim) override;
 private:
-    std::string filename;
-    mutable std::mutex fileMutex;
-    std::ofstream file;  
+    std::shared_ptr<FileSink> sink;
+};
+struct NPCSnapshot {
+    int x = 0;
+    int y = 0;
+    bool alive = false;
+    char symbol = '?';
+};
+// Опубликованное состояние мира на конец такта; индексы совпадают с Game::npcs.
+// alive и aliveByKind посчитаны по флагам npcs[i].alive этого же снимка.
+struct WorldSnapshot {
+    uint64_t tick = 0;
+    std::vector<NPCSnapshot> npcs;
+    int alive = 0;
+    std::array<int, NPC_KIND_COUNT> aliveByKind{};
+};
+// Тройной буфер: симуляция заполняет свободный скрытый буфер и публикует его
+// сменой индекса. Читатели не берут блокировок; писатель берёт любой буфер,
+// кроме опубликованного, из которого ушли читатели, так что один медленный
+// читатель симуляцию не держит. Ждать приходится, только если читатели заняли
+// оба скрытых буфера, поэтому ReadGuard всё равно не стоит держать долго.
+class WorldBuffer {
+public:
+    class ReadGuard {
+    public:
+        ReadGuard(const WorldBuffer& owner, int index) : owner(&owner), index(index) {}
+        ReadGuard(ReadGuard&& other) noexcept : owner(other.owner), index(other.index) { other.owner = nullptr; }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+        ~ReadGuard() { if (owner) owner->readers[index].fetch_sub(1); }
+        const WorldSnapshot& operator*() const { return owner->buffers[index]; }
+        const WorldSnapshot* operator->() const { return &owner->buffers[index]; }
+    private:
+        const WorldBuffer* owner;
+        int index;
+    };
+
+    ReadGuard read() const;
+    WorldSnapshot& beginWrite();
+    void publish();
+private:
+    static const int kBuffers = 3;
+    WorldSnapshot buffers[kBuffers];
+    std::atomic<int> front{0};
+    int back = 1;   // только для писателя
+    mutable std::atomic<int> readers[kBuffers] = {0, 0, 0};
 };
 class NPCFactory {
 public:
@@ -161,28 +322,74 @@ public:
     
     static std::vector<std::shared_ptr<NPC>> createRandomNPCs(int count);
     static void printMap(const std::vector<std::shared_ptr<NPC>>& npcs);
+    static void printMap(const WorldSnapshot& world);
+    static std::string formatMap(const WorldSnapshot& world);
+    // Счётчики считаются по тем же флагам alive, что копируются в снимок.
+    static void fillSnapshot(const std::vector<std::shared_ptr<NPC>>& npcs, WorldSnapshot& world);
     static std::vector<std::string> getAvailableTypes();
-    static void printDetailedStats(const std::vector<std::shared_ptr<NPC>>& npcs);
+    static void printDetailedStats(const Population& population, size_t total);
 };
 class Game {
 public:
+    // Фаза текущего такта; бои разбираются только в Resolve.
+    enum class Phase { Idle, Move, Detect, Resolve, Publish };
+
     Game();
+    explicit Game(std::vector<std::shared_ptr<NPC>> npcs);
     ~Game();
     
     void start();
     void stop();
+    // Наблюдатели гибели NPC; добавлять до start().
+    void addObserver(std::shared_ptr<Observer> observer) { observers.push_back(std::move(observer)); }
+    Phase phase() const { return currentPhase.load(); }
+    // Последний опубликованный такт; безопасно читать из любого потока.
+    WorldBuffer::ReadGuard snapshot() const { return world.read(); }
+    const Population& getPopulation() const { return *population; }
+    // Один такт симуляции: движение -> поиск столкновений -> бои -> публикация.
+    // Фазы пишут только в следующее состояние такта; живые NPC и снимок
+    // обновляет publish().
+    void tick();
 private:
+    class TickVisitor;
+    // Состояние мира на такт; индексы совпадают с npcs.
+    struct TickState {
+        std::vector<Position> positions;
+        std::vector<char> alive;
+    };
+    TickState& nextState() { return states[1 - current]; }
+    void moveAll();
+    void detectEngagements();
+    void resolveBattles();
+    void resolveTask(const BattleTask& task);
+    void publish();
     void movementThread();
     void battleThread();
     void mainThread();
     void printFinalResults(); 
+    // Сбрасывает running под queueMutex и будит всех ждущих: проверка предиката
+    // и засыпание на условной переменной не могут разминуться с остановкой.
+    void halt();
+    std::shared_ptr<Population> population = std::make_shared<Population>();
     std::vector<std::shared_ptr<NPC>> npcs;
+    std::unordered_map<const NPC*, size_t> slots;
+    TickState states[2];
+    int current = 0;
+    uint64_t tickCount = 0;
+    // Столкновения текущего такта; battleThread получает их целиком в resolveBattles.
+    std::vector<BattleTask> engagements;
+    std::vector<std::shared_ptr<Observer>> observers;
+    std::atomic<Phase> currentPhase{Phase::Idle};
     std::thread movementThreadObj;
     std::thread battleThreadObj;
     std::thread mainThreadObj;
-    std::queue<BattleTask> battleQueue;
+    std::vector<BattleTask> battleQueue;
     std::mutex queueMutex;
     std::condition_variable queueCV;
+    std::condition_variable resolvedCV;
+    bool resolving = false;
+    WorldBuffer world;
     std::atomic<bool> running{false};
     std::atomic<bool> gameOver{false};
+    int battleCount = 0;
 };
\ No newline at end of file
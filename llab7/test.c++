@@ -99,6 +99,208 @@ TEST_F(NPCTest, GameCreation) {
     Game game;
     SUCCEED();
 }
+TEST_F(NPCTest, TickPublishesSnapshot) {
+    Game game;
+    {
+        auto view = game.snapshot();
+        EXPECT_EQ(view->tick, 1u);
+        ASSERT_EQ(view->npcs.size(), 50u);
+        for (const auto& npc : view->npcs) {
+            EXPECT_TRUE(npc.alive);
+            EXPECT_GE(npc.x, 0);
+            EXPECT_LT(npc.x, MAP_WIDTH);
+        }
+    }
+    for (int i = 0; i < 5; ++i) game.tick();
+    EXPECT_EQ(game.snapshot()->tick, 6u);
+}
+TEST_F(NPCTest, WorldBufferReadersSeeWholeTicks) {
+    WorldBuffer world;
+    std::atomic<bool> done{false};
+    std::atomic<int> mixed{0};
+
+    std::thread reader([&]() {
+        while (!done) {
+            auto view = world.read();
+            for (const auto& npc : view->npcs) {
+                if (npc.x != static_cast<int>(view->tick)) mixed++;
+            }
+        }
+    });
+    for (int t = 1; t <= 2000; ++t) {
+        WorldSnapshot& next = world.beginWrite();
+        next.tick = static_cast<uint64_t>(t);
+        next.npcs.assign(16, NPCSnapshot{t, t, true, 'K'});
+        world.publish();
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(mixed.load(), 0);
+    EXPECT_EQ(world.read()->tick, 2000u);
+}
+class CaptureSink : public LogSink {
+public:
+    void write(const std::string& text) override { lines.push_back(text); }
+    std::vector<std::string> lines;
+};
+TEST_F(NPCTest, LoggerKeepsPerThreadOrder) {
+    auto capture = std::make_shared<CaptureSink>();
+    auto previous = Logger::instance().setSinks({capture});
+    uint64_t droppedBefore = Logger::instance().dropped();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < 3000; ++i) {
+                Logger::instance().log(std::to_string(t) + ":" + std::to_string(i));
+            }
+        });
+    }
+    for (auto& th : threads) th.join();
+    Logger::instance().flush();
+    Logger::instance().setSinks(previous);
+
+    // Переполнение буфера отбрасывает записи, но не меняет порядок оставшихся.
+    ASSERT_EQ(capture->lines.size() + (Logger::instance().dropped() - droppedBefore), 12000u);
+    std::map<int, int> last;
+    for (const auto& line : capture->lines) {
+        int t = std::stoi(line.substr(0, line.find(':')));
+        int i = std::stoi(line.substr(line.find(':') + 1));
+        auto it = last.find(t);
+        if (it != last.end()) EXPECT_GT(i, it->second);
+        last[t] = i;
+    }
+}
+class StalledSink : public LogSink {
+public:
+    void write(const std::string& text) override {
+        entered = true;
+        while (!released) std::this_thread::yield();
+        lines.push_back(text);
+    }
+    std::atomic<bool> entered{false};
+    std::atomic<bool> released{false};
+    std::vector<std::string> lines;
+};
+TEST_F(NPCTest, LoggerDropsInsteadOfBlockingOnStalledWriter) {
+    auto stalled = std::make_shared<StalledSink>();
+    auto previous = Logger::instance().setSinks({stalled});
+    uint64_t droppedBefore = Logger::instance().dropped();
+
+    Logger::instance().log("first");
+    while (!stalled->entered) std::this_thread::yield();
+    // Писатель стоит в приёмнике; log() всё равно возвращается сразу.
+    const int extra = 3000;
+    for (int i = 0; i < extra; ++i) Logger::instance().log(std::to_string(i));
+    uint64_t dropped = Logger::instance().dropped() - droppedBefore;
+    EXPECT_GT(dropped, 0u);
+
+    stalled->released = true;
+    Logger::instance().flush();
+    Logger::instance().setSinks(previous);
+    EXPECT_EQ(stalled->lines.size() + dropped, static_cast<size_t>(extra + 1));
+    EXPECT_EQ(stalled->lines.front(), "first");
+}
+TEST_F(NPCTest, LoggerRoutesTargetedRecords) {
+    auto common = std::make_shared<CaptureSink>();
+    auto target = std::make_shared<CaptureSink>();
+    auto previous = Logger::instance().setSinks({common});
+    Logger::instance().log("shared\n");
+    Logger::instance().log(target, "only target\n");
+    Logger::instance().flush();
+    Logger::instance().setSinks(previous);
+
+    EXPECT_EQ(common->lines, std::vector<std::string>{"shared\n"});
+    EXPECT_EQ(target->lines, std::vector<std::string>{"only target\n"});
+}
+TEST_F(NPCTest, GameRunsAndStops) {
+    auto capture = std::make_shared<CaptureSink>();
+    auto previous = Logger::instance().setSinks({capture});
+    {
+        Game game;
+        game.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(1200));
+        game.stop();
+    }
+    Logger::instance().flush();
+    Logger::instance().setSinks(previous);
+
+    bool sawTime = false, sawGameOver = false;
+    for (const auto& line : capture->lines) {
+        if (line.find("=== TIME: 1s") != std::string::npos) sawTime = true;
+        if (line.find("=== GAME OVER ===") != std::string::npos) sawGameOver = true;
+    }
+    EXPECT_TRUE(sawTime);
+    EXPECT_TRUE(sawGameOver);
+}
+TEST_F(NPCTest, PopulationCountersFollowKills) {
+    auto population = std::make_shared<Population>();
+    auto knight = std::make_shared<Knight>(0, 0, "K");
+    auto elf = std::make_shared<Elf>(0, 0, "E");
+    auto dragon = std::make_shared<Dragon>(0, 0, "D");
+    auto corpse = std::make_shared<Dragon>(0, 0, "Dead");
+    corpse->kill();
+    for (auto& npc : std::vector<std::shared_ptr<NPC>>{knight, elf, dragon, corpse}) npc->joinPopulation(population);
+
+    EXPECT_EQ(population->total(), 3);
+    EXPECT_EQ(population->alive(NPCKind::Dragon), 1);
+    dragon->kill();
+    dragon->kill();
+    EXPECT_EQ(population->alive(NPCKind::Dragon), 0);
+    EXPECT_EQ(population->alive(NPCKind::Knight), 1);
+    EXPECT_EQ(population->total(), 2);
+
+    // Повторное вступление переводит NPC, а не считает его дважды.
+    auto other = std::make_shared<Population>();
+    knight->joinPopulation(other);
+    knight->joinPopulation(other);
+    EXPECT_EQ(population->alive(NPCKind::Knight), 0);
+    EXPECT_EQ(other->alive(NPCKind::Knight), 1);
+
+    // NPC переживает свою популяцию: поздняя гибель не трогает освобождённую память.
+    std::weak_ptr<Population> gone = other;
+    other.reset();
+    EXPECT_FALSE(gone.expired());
+    knight->kill();
+    EXPECT_EQ(gone.lock()->alive(NPCKind::Knight), 0);
+
+    Game game;
+    auto view = game.snapshot();
+    EXPECT_EQ(game.getPopulation().total(), 50);
+    EXPECT_EQ(view->alive, 50);
+    int sum = 0;
+    for (int k = 0; k < NPC_KIND_COUNT; ++k) {
+        EXPECT_EQ(view->aliveByKind[k], game.getPopulation().alive(static_cast<NPCKind>(k)));
+        sum += view->aliveByKind[k];
+    }
+    EXPECT_EQ(sum, 50);
+}
+TEST_F(NPCTest, SnapshotCountsMatchFlags) {
+    std::vector<std::shared_ptr<NPC>> npcs = {std::make_shared<Knight>(1, 1, "K"), std::make_shared<Elf>(2, 2, "E"),
+                                              std::make_shared<Dragon>(3, 3, "D"), std::make_shared<Dragon>(4, 4, "D2")};
+    npcs[2]->kill();
+    WorldSnapshot world;
+    NPCFactory::fillSnapshot(npcs, world);
+    EXPECT_EQ(world.alive, 3);
+    EXPECT_EQ(world.aliveByKind[static_cast<int>(NPCKind::Dragon)], 1);
+    EXPECT_FALSE(world.npcs[2].alive);
+
+    Game game;
+    for (int t = 0; t < 10; ++t) {
+        game.tick();
+        auto view = game.snapshot();
+        std::array<int, NPC_KIND_COUNT> byKind{};
+        int alive = 0;
+        for (const auto& npc : view->npcs) {
+            if (!npc.alive) continue;
+            alive++;
+            byKind[npc.symbol == 'K' ? 0 : npc.symbol == 'E' ? 1 : 2]++;
+        }
+        EXPECT_EQ(view->alive, alive);
+        EXPECT_EQ(view->aliveByKind, byKind);
+    }
+}
 TEST_F(NPCTest, MapSymbols) {
     auto knight = std::make_shared<Knight>(0, 0, "K");
     auto elf = std::make_shared<Elf>(0, 0, "E");
@@ -151,6 +353,29 @@ TEST_F(NPCTest, ThreadSafety) {
     EXPECT_TRUE(npc1->isAlive());
     EXPECT_TRUE(npc2->isAlive());
 }
+TEST_F(NPCTest, PositionSnapshotIsConsistent) {
+    auto npc = std::make_shared<Dragon>(0, 0, "Snapshot");
+    std::atomic<bool> done{false};
+    std::atomic<int> torn{0};
+
+    std::thread reader([&]() {
+        while (!done) {
+            Position p = npc->getPosition();
+            if (p.x != p.y) torn++;
+        }
+    });
+    for (int i = 0; i < 100000; ++i) {
+        npc->setPosition(i % MAP_WIDTH, i % MAP_HEIGHT);
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(torn.load(), 0);
+    npc->setPosition(MAP_WIDTH - 1, 0);
+    EXPECT_EQ(npc->getX(), MAP_WIDTH - 1);
+    EXPECT_EQ(npc->getY(), 0);
+    EXPECT_LT(sizeof(Knight), sizeof(std::string) + 64);
+}
 TEST_F(NPCTest, ObserverThreadSafety) {
     FileObserver observer("thread_test_log.txt");
     
@@ -167,6 +392,7 @@ TEST_F(NPCTest, ObserverThreadSafety) {
     for (auto& t : threads) {
         t.join();
     }
+    Logger::instance().flush();
     
     std::ifstream log("thread_test_log.txt");
     ASSERT_TRUE(log.good());
@@ -200,23 +426,79 @@ TEST_F(NPCTest, FactoryAvailableTypes) {
     EXPECT_TRUE(hasDragon);
 }
 TEST_F(NPCTest, BattleLogic) {
-    std::queue<BattleTask> battleQueue;
-    std::mutex queueMutex;
-    std::condition_variable queueCV;
-    
-    BattleVisitor visitor(battleQueue, queueMutex, queueCV);
+    std::vector<BattleTask> engagements;
+    BattleVisitor visitor(engagements);
     
     auto knight = std::make_shared<Knight>(0, 0, "Knight");
     auto dragon = std::make_shared<Dragon>(5, 0, "Dragon");
     auto elf = std::make_shared<Elf>(10, 0, "Elf");
     
     knight->accept(visitor, dragon);
-    EXPECT_FALSE(battleQueue.empty());
+    ASSERT_EQ(engagements.size(), 1u);
+    // Обход только собирает пары, никто не гибнет.
+    EXPECT_TRUE(dragon->isAlive());
     
-    while (!battleQueue.empty()) battleQueue.pop();
+    engagements.clear();
     
     elf->accept(visitor, knight);
-    EXPECT_FALSE(battleQueue.empty());
+    EXPECT_FALSE(engagements.empty());
+    dragon->accept(visitor, knight);
+    EXPECT_EQ(engagements.size(), 1u);
+}
+class PhaseObserver : public Observer {
+public:
+    explicit PhaseObserver(const Game& game) : game(game) {}
+    void onKill(const std::string&, const std::string&) override {
+        kills++;
+        if (game.phase() != Game::Phase::Resolve) outsideResolve++;
+    }
+    const Game& game;
+    std::atomic<int> kills{0};
+    std::atomic<int> outsideResolve{0};
+};
+TEST_F(NPCTest, KillsHappenOnlyInResolvePhase) {
+    auto capture = std::make_shared<CaptureSink>();
+    auto previous = Logger::instance().setSinks({capture});
+    std::vector<std::shared_ptr<NPC>> npcs;
+    for (int i = 0; i < 30; ++i) {
+        npcs.push_back(std::make_shared<Knight>(0, 0, "K" + std::to_string(i)));
+        npcs.push_back(std::make_shared<Dragon>(0, 0, "D" + std::to_string(i)));
+    }
+    {
+        Game game(npcs);
+        auto phases = std::make_shared<PhaseObserver>(game);
+        game.addObserver(phases);
+        for (int i = 0; i < 3; ++i) game.tick();
+        game.start();
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        game.stop();
+
+        EXPECT_GT(phases->kills.load(), 0);
+        EXPECT_EQ(phases->outsideResolve.load(), 0);
+        // Живые NPC, счётчики и снимок меняются только в publish() и сходятся.
+        auto view = game.snapshot();
+        int alive = 0;
+        for (size_t i = 0; i < npcs.size(); ++i) {
+            EXPECT_EQ(view->npcs[i].alive, npcs[i]->isAlive());
+            alive += npcs[i]->isAlive();
+        }
+        EXPECT_EQ(view->alive, alive);
+        EXPECT_EQ(game.getPopulation().total(), alive);
+        EXPECT_EQ(static_cast<int>(npcs.size()) - alive, phases->kills.load());
+    }
+    Logger::instance().flush();
+    Logger::instance().setSinks(previous);
+}
+TEST_F(NPCTest, WorldBufferDoesNotWaitForSlowReader) {
+    WorldBuffer world;
+    auto slow = world.read();
+    for (int t = 1; t <= 10; ++t) {
+        WorldSnapshot& next = world.beginWrite();
+        next.tick = static_cast<uint64_t>(t);
+        world.publish();
+    }
+    EXPECT_EQ(slow->tick, 0u);
+    EXPECT_EQ(world.read()->tick, 10u);
 }
 TEST_F(NPCTest, KillMethod) {
     auto npc = std::make_shared<Knight>(50, 50, "Test");